@@ -1,4 +1,5 @@
 #include "controller/phonebook_controller.hpp"
+#include "controller/debug_controller.hpp"
 #include "app_component.hpp"
 #include "oatpp-swagger/Controller.hpp"
 #include "oatpp/network/Server.hpp"
@@ -8,7 +9,8 @@
 #include <memory>
 
 void run() {
-  AppComponent components; 
+  AppConfig config = AppConfig::fromEnvironment();
+  AppComponent components(config);
 
   OATPP_COMPONENT(std::shared_ptr<oatpp::web::server::HttpRouter>, router);
   OATPP_COMPONENT(std::shared_ptr<oatpp::data::mapping::ObjectMapper>, objectMapper);
@@ -18,6 +20,13 @@ void run() {
   auto endpoints = std::make_shared<oatpp::web::server::api::Endpoints>();
   endpoints->append(phonebookController->getEndpoints());
 
+  // PHONEBOOK_DEBUG_ENDPOINTS=1
+  if (config.debugEndpoints) {
+    auto debugController = std::make_shared<DebugController>(objectMapper);
+    router->addController(debugController);
+    endpoints->append(debugController->getEndpoints());
+  }
+
   OATPP_COMPONENT(std::shared_ptr<oatpp::swagger::DocumentInfo>, docInfo);
   OATPP_COMPONENT(std::shared_ptr<oatpp::swagger::Resources>, resources);
 
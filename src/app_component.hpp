@@ -1,11 +1,15 @@
 #pragma once
 
+#include "app_config.hpp"
 #include "service/phonebook_service.hpp"
 #include "repository/iphonebook_repository.hpp"
 #include "repository/phonebook_repository.hpp"
+#include "repository/snapshot_phonebook_repository.hpp"
 #include "error_handler.hpp"
+#include "error_responses.hpp"
 
 #include "interceptor/request_interceptor.hpp" 
+#include "interceptor/response_interceptor.hpp"
 
 #include "oatpp-swagger/Model.hpp"
 #include "oatpp-swagger/Resources.hpp"
@@ -19,7 +23,14 @@
 #include <memory>
 
 class AppComponent {
+private:
+  AppConfig m_config;
+
 public:
+  AppComponent(const AppConfig& config = AppConfig::fromEnvironment())
+    : m_config(config)
+  {}
+
   OATPP_CREATE_COMPONENT(std::shared_ptr<oatpp::swagger::DocumentInfo>, swaggerDocumentInfo)([] {
     oatpp::swagger::DocumentInfo::Builder builder;
     builder.setTitle("Phonebook API")
@@ -30,7 +41,11 @@ public:
   OATPP_CREATE_COMPONENT(std::shared_ptr<oatpp::swagger::Resources>, swaggerResources)([] {
     return oatpp::swagger::Resources::loadResources(SWAGGER_RES_PATH);}());
 
-  OATPP_CREATE_COMPONENT(std::shared_ptr<IPhonebookRepository>, repository)([] {
+  OATPP_CREATE_COMPONENT(std::shared_ptr<IPhonebookRepository>, repository)([this]() -> std::shared_ptr<IPhonebookRepository> {
+    // The MVCC repository keeps full listings from holding up writes.
+    if (m_config.snapshotRepository) {
+      return std::make_shared<SnapshotPhonebookRepository>();
+    }
     return std::make_shared<PhonebookRepository>();}());
 
   OATPP_CREATE_COMPONENT(std::shared_ptr<PhonebookService>, service)([] {
@@ -40,19 +55,29 @@ public:
   OATPP_CREATE_COMPONENT(std::shared_ptr<oatpp::data::mapping::ObjectMapper>, apiObjectMapper)([] {
     return oatpp::parser::json::mapping::ObjectMapper::createShared();}());
 
+  OATPP_CREATE_COMPONENT(std::shared_ptr<ErrorResponses>, errorResponses)([] {
+    OATPP_COMPONENT(std::shared_ptr<oatpp::data::mapping::ObjectMapper>, objectMapper);
+    return std::make_shared<ErrorResponses>(objectMapper);}());
+
+  OATPP_CREATE_COMPONENT(std::shared_ptr<SlowRequestLog>, slowRequestLog)([this] {
+    return std::make_shared<SlowRequestLog>(m_config.slowRequestThresholdMicros);}());
+
   OATPP_CREATE_COMPONENT(std::shared_ptr<oatpp::network::ServerConnectionProvider>, serverConnectionProvider)([] {
     return oatpp::network::tcp::server::ConnectionProvider::createShared({"0.0.0.0", 8000, oatpp::network::Address::IP_4});}());
 
   OATPP_CREATE_COMPONENT(std::shared_ptr<oatpp::web::server::HttpRouter>, httpRouter)([] {
     return oatpp::web::server::HttpRouter::createShared();}());
 
-  OATPP_CREATE_COMPONENT(std::shared_ptr<oatpp::network::ConnectionHandler>, serverConnectionHandler)([] {
+  OATPP_CREATE_COMPONENT(std::shared_ptr<oatpp::network::ConnectionHandler>, serverConnectionHandler)([this] {
     OATPP_COMPONENT(std::shared_ptr<oatpp::web::server::HttpRouter>, router);
     OATPP_COMPONENT(std::shared_ptr<oatpp::data::mapping::ObjectMapper>, objectMapper);
+    OATPP_COMPONENT(std::shared_ptr<ErrorResponses>, errorResponses);
+    OATPP_COMPONENT(std::shared_ptr<SlowRequestLog>, slowRequestLog);
 
     auto connectionHandler = oatpp::web::server::HttpConnectionHandler::createShared(router);
     connectionHandler->setErrorHandler(std::make_shared<ErrorHandler>(objectMapper));
-    connectionHandler->addRequestInterceptor(std::make_shared<MyRequestInterceptor>());
+    connectionHandler->addRequestInterceptor(std::make_shared<MyRequestInterceptor>(errorResponses, m_config.rateLimits, m_config.apiKeys));
+    connectionHandler->addResponseInterceptor(std::make_shared<RequestTimingInterceptor>(slowRequestLog, m_config.serverTiming));
 
     return connectionHandler;
   }());
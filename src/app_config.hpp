@@ -0,0 +1,114 @@
+#pragma once
+
+#include "interceptor/rate_limiter.hpp"
+#include "timing/request_timing.hpp"
+#include "oatpp/core/base/Environment.hpp"
+
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+/**
+ * Settings the components are built from. The server reads them from the environment,
+ * tests construct them directly.
+ */
+struct AppConfig {
+  std::vector<RateLimitRule> rateLimits;
+  // X-API-Key values accepted as the client identity; other requests are limited by peer address.
+  std::unordered_set<std::string> apiKeys;
+  // Adds the per-stage breakdown to every response as a Server-Timing header.
+  bool serverTiming = false;
+  // Serves GET /debug/slow-requests. It has no auth, keep it off on public deployments.
+  bool debugEndpoints = false;
+  v_uint64 slowRequestThresholdMicros = SlowRequestLog::DEFAULT_THRESHOLD_MICROS;
+  // MVCC SnapshotPhonebookRepository instead of the locking PhonebookRepository.
+  bool snapshotRepository = false;
+
+  static std::vector<RateLimitRule> defaultRateLimits() {
+    return {
+      // method, path, requests per second, burst (per client)
+      {"POST", "/contacts", 20, 40},
+      {"PUT", "/contacts/*", 20, 40},
+      {"DELETE", "/contacts/*", 20, 40}
+    };
+  }
+
+  /**
+   * Parse rules in the form "METHOD PATH RATE BURST", separated by ';'.
+   * @param value - e.g. "POST /contacts 20 40;DELETE /contacts/* 5 10".
+   * @param rules - parsed rules are appended here.
+   * @return - false if any rule is malformed.
+   */
+  static bool parseRateLimits(const std::string& value, std::vector<RateLimitRule>& rules) {
+    std::stringstream stream(value);
+    std::string entry;
+    while (std::getline(stream, entry, ';')) {
+      if (entry.find_first_not_of(' ') == std::string::npos) {
+        continue;
+      }
+      std::istringstream fields(entry);
+      RateLimitRule rule;
+      std::string rest;
+      if (!(fields >> rule.method >> rule.path >> rule.ratePerSecond >> rule.burst) || (fields >> rest)
+          || rule.ratePerSecond < 0 || rule.burst < 1) {
+        return false;
+      }
+      rules.push_back(rule);
+    }
+    return true;
+  }
+
+  static AppConfig fromEnvironment() {
+    AppConfig config;
+
+    // PHONEBOOK_RATE_LIMITS="POST /contacts 20 40;PUT /contacts/* 20 40", an empty value disables limiting
+    const char* limits = std::getenv("PHONEBOOK_RATE_LIMITS");
+    if (!limits || !parseRateLimits(limits, config.rateLimits)) {
+      if (limits) {
+        OATPP_LOGE("AppConfig", "Malformed PHONEBOOK_RATE_LIMITS, falling back to the default limits");
+      }
+      config.rateLimits = defaultRateLimits();
+    }
+
+    // PHONEBOOK_API_KEYS=key1,key2
+    if (const char* keys = std::getenv("PHONEBOOK_API_KEYS")) {
+      std::stringstream stream(keys);
+      std::string key;
+      while (std::getline(stream, key, ',')) {
+        if (!key.empty()) {
+          config.apiKeys.insert(key);
+        }
+      }
+    }
+
+    config.serverTiming = isEnabled("PHONEBOOK_SERVER_TIMING");
+    config.debugEndpoints = isEnabled("PHONEBOOK_DEBUG_ENDPOINTS");
+
+    // PHONEBOOK_SLOW_REQUEST_MICROS=20000
+    if (const char* threshold = std::getenv("PHONEBOOK_SLOW_REQUEST_MICROS")) {
+      char* end = nullptr;
+      unsigned long long value = std::strtoull(threshold, &end, 10);
+      if (end != threshold && *end == '\0') {
+        config.slowRequestThresholdMicros = value;
+      } else {
+        OATPP_LOGE("AppConfig", "Malformed PHONEBOOK_SLOW_REQUEST_MICROS, keeping %llu",
+                   (unsigned long long) config.slowRequestThresholdMicros);
+      }
+    }
+
+    // PHONEBOOK_REPOSITORY=snapshot
+    const char* repository = std::getenv("PHONEBOOK_REPOSITORY");
+    config.snapshotRepository = repository && std::strcmp(repository, "snapshot") == 0;
+    return config;
+  }
+
+private:
+  // VAR=1
+  static bool isEnabled(const char* name) {
+    const char* value = std::getenv(name);
+    return value && std::strcmp(value, "1") == 0;
+  }
+};
@@ -0,0 +1,40 @@
+#pragma once
+
+#include "dto/debug_dto.hpp"
+#include "timing/request_timing.hpp"
+#include "oatpp/web/server/api/ApiController.hpp"
+#include "oatpp/core/macro/codegen.hpp"
+#include "oatpp/core/macro/component.hpp"
+
+#include OATPP_CODEGEN_BEGIN(ApiController)
+
+class DebugController : public oatpp::web::server::api::ApiController {
+private:
+  std::shared_ptr<SlowRequestLog> m_slowRequests;
+public:
+  DebugController(const std::shared_ptr<ObjectMapper>& objectMapper)
+    : oatpp::web::server::api::ApiController(objectMapper)
+    , m_slowRequests(OATPP_GET_COMPONENT(std::shared_ptr<SlowRequestLog>))
+  {}
+
+  ENDPOINT_INFO(getSlowRequests) {
+    info->summary = "Slowest recent requests with per-stage timings (ms)";
+    info->addResponse<List<Object<SlowRequestDto>>>(Status::CODE_200, "application/json");
+  }
+  ENDPOINT("GET", "/debug/slow-requests", getSlowRequests) {
+    auto list = List<Object<SlowRequestDto>>::createShared();
+    for (const auto& record : m_slowRequests->getRecords()) {
+      auto dto = SlowRequestDto::createShared();
+      dto->request = record.label;
+      dto->total_ms = record.totalMs;
+      dto->stages_ms = oatpp::Fields<oatpp::Float64>::createShared();
+      for (int i = 0; i < (int) RequestStage::COUNT; i++) {
+        dto->stages_ms->push_back({RequestTiming::getStageName((RequestStage) i), record.stageMs[i]});
+      }
+      list->push_back(dto);
+    }
+    return createDtoResponse(Status::CODE_200, list);
+  }
+};
+
+#include OATPP_CODEGEN_END(ApiController)
@@ -1,7 +1,10 @@
 #pragma once
 
 #include "service/phonebook_service.hpp"
+#include "error_responses.hpp"
+#include "timing/request_timing.hpp"
 #include "oatpp/web/server/api/ApiController.hpp"
+#include "oatpp/encoding/Url.hpp"
 #include "oatpp/core/macro/codegen.hpp"
 #include "oatpp/core/macro/component.hpp"
 
@@ -10,18 +13,59 @@
 class PhonebookController : public oatpp::web::server::api::ApiController {
 private:
   PhonebookService m_service; 
+  std::shared_ptr<ErrorResponses> m_errorResponses;
+
+  template<class T>
+  std::shared_ptr<OutgoingResponse> createResultResponse(const Result<T>& result) {
+    if (!result.ok()) {
+      return m_errorResponses->createResponse(result.getError());
+    }
+    StageTimer timer(RequestStage::SERIALIZE);
+    return createDtoResponse(Status::CODE_200, result.getValue());
+  }
+
+  // Body is read here rather than with BODY_DTO so that parsing shows up in the stage breakdown.
+  Object<ContactPayloadDto> readPayload(const std::shared_ptr<IncomingRequest>& request) {
+    StageTimer timer(RequestStage::PARSE);
+    return request->readBodyToDto<Object<ContactPayloadDto>>(getDefaultObjectMapper().get());
+  }
 public:
   PhonebookController(const std::shared_ptr<ObjectMapper>& objectMapper)
     : oatpp::web::server::api::ApiController(objectMapper)
     , m_service(OATPP_GET_COMPONENT(std::shared_ptr<IPhonebookRepository>)) 
+    , m_errorResponses(OATPP_GET_COMPONENT(std::shared_ptr<ErrorResponses>))
   {}
 
   ENDPOINT_INFO(getAllContacts) {
     info->summary = "Get all contacts";
+    info->queryParams.add<String>("sort").description = "Sort field: id (default), name, phone";
+    info->queryParams["sort"].required = false;
+    info->queryParams.add<String>("order").description = "Sort order: asc (default), desc";
+    info->queryParams["order"].required = false;
+    info->queryParams.add<String>("after").description = "Cursor from X-Next-Cursor of the previous page, the page starts right after its last contact";
+    info->queryParams["after"].required = false;
+    info->queryParams.add<Int64>("offset").description = "Number of contacts to skip";
+    info->queryParams["offset"].required = false;
+    info->queryParams.add<Int64>("limit").description = "Max number of contacts to return";
+    info->queryParams["limit"].required = false;
     info->addResponse<List<Object<ContactDto>>>(Status::CODE_200, "application/json");
+    info->addResponse<Object<StatusDto>>(Status::CODE_400, "application/json");
   }
-  ENDPOINT("GET", "/contacts", getAllContacts) {
-    return createDtoResponse(Status::CODE_200, m_service.getAllContacts());
+  ENDPOINT("GET", "/contacts", getAllContacts, REQUEST(std::shared_ptr<IncomingRequest>, request)) {
+    auto page = m_service.getAllContacts(
+      request->getQueryParameter("sort"),
+      request->getQueryParameter("order"),
+      request->getQueryParameter("after"),
+      request->getQueryParameter("offset"),
+      request->getQueryParameter("limit"));
+    if (!page.ok()) {
+      return m_errorResponses->createResponse(page.getError());
+    }
+    auto response = createResultResponse(Result<List<Object<ContactDto>>>(page.getValue().contacts));
+    if (page.getValue().nextCursor) {
+      response->putHeader("X-Next-Cursor", page.getValue().nextCursor);
+    }
+    return response;
   }
 
   ENDPOINT_INFO(getContactById) {
@@ -30,7 +74,23 @@ public:
     info->addResponse<Object<StatusDto>>(Status::CODE_404, "application/json");
   }
   ENDPOINT("GET", "/contacts/{contactId}", getContactById, PATH(Int64, contactId)) {
-    return createDtoResponse(Status::CODE_200, m_service.getContactById(contactId));
+    return createResultResponse(m_service.getContactById(contactId));
+  }
+
+  ENDPOINT_INFO(getContactByPhone) {
+    info->summary = "Get contact by phone number";
+    info->pathParams["phone"].description = "Phone number, +375XXXXXXXXX";
+    info->addResponse<Object<ContactDto>>(Status::CODE_200, "application/json");
+    info->addResponse<Object<StatusDto>>(Status::CODE_400, "application/json");
+    info->addResponse<Object<StatusDto>>(Status::CODE_404, "application/json");
+  }
+  ENDPOINT("GET", "/contacts/by-phone/{phone}", getContactByPhone, PATH(String, phone)) {
+    // '+' may arrive percent-encoded or be dropped altogether in the path.
+    std::string value = *oatpp::encoding::Url::decode(phone);
+    if (value.empty() || value[0] != '+') {
+      value.insert(0, 1, '+');
+    }
+    return createResultResponse(m_service.getContactByPhone(value));
   }
 
   ENDPOINT_INFO(createContact) {
@@ -40,8 +100,12 @@ public:
     info->addResponse<Object<StatusDto>>(Status::CODE_400, "application/json");
     info->addResponse<Object<StatusDto>>(Status::CODE_409, "application/json");
   }
-  ENDPOINT("POST", "/contacts", createContact, BODY_DTO(Object<ContactPayloadDto>, payload)) {
-    return createDtoResponse(Status::CODE_200, m_service.createContact(payload));
+  ENDPOINT("POST", "/contacts", createContact, REQUEST(std::shared_ptr<IncomingRequest>, request)) {
+    auto payload = readPayload(request);
+    if (!payload) {
+      return m_errorResponses->createResponse(ErrorCode::BODY_REQUIRED);
+    }
+    return createResultResponse(m_service.createContact(payload));
   }
 
   ENDPOINT_INFO(updateContact) {
@@ -52,8 +116,12 @@ public:
     info->addResponse<Object<StatusDto>>(Status::CODE_400, "application/json");
     info->addResponse<Object<StatusDto>>(Status::CODE_409, "application/json");
   }
-  ENDPOINT("PUT", "/contacts/{contactId}", updateContact, PATH(Int64, contactId), BODY_DTO(Object<ContactPayloadDto>, payload)) {
-    return createDtoResponse(Status::CODE_200, m_service.updateContact(contactId, payload));
+  ENDPOINT("PUT", "/contacts/{contactId}", updateContact, PATH(Int64, contactId), REQUEST(std::shared_ptr<IncomingRequest>, request)) {
+    auto payload = readPayload(request);
+    if (!payload) {
+      return m_errorResponses->createResponse(ErrorCode::BODY_REQUIRED);
+    }
+    return createResultResponse(m_service.updateContact(contactId, payload));
   }
 
   ENDPOINT_INFO(deleteContact) {
@@ -62,7 +130,10 @@ public:
     info->addResponse<Object<StatusDto>>(Status::CODE_404, "application/json");
   }
   ENDPOINT("DELETE", "/contacts/{contactId}", deleteContact, PATH(Int64, contactId)) {
-    m_service.deleteContact(contactId);
+    ErrorCode error = m_service.deleteContact(contactId);
+    if (error != ErrorCode::NONE) {
+      return m_errorResponses->createResponse(error);
+    }
     return createResponse(Status::CODE_200, "Contact deleted successfully");
   }
 };
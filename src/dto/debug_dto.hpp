@@ -0,0 +1,15 @@
+#pragma once
+
+#include "oatpp/core/macro/codegen.hpp"
+#include "oatpp/core/Types.hpp"
+
+#include OATPP_CODEGEN_BEGIN(DTO)
+
+class SlowRequestDto : public oatpp::DTO {
+  DTO_INIT(SlowRequestDto, DTO)
+  DTO_FIELD(String, request);
+  DTO_FIELD(Float64, total_ms, "totalMs");
+  DTO_FIELD(Fields<Float64>, stages_ms, "stagesMs");
+};
+
+#include OATPP_CODEGEN_END(DTO)
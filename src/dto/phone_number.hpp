@@ -0,0 +1,43 @@
+#pragma once
+
+#include "oatpp/core/Types.hpp"
+
+/**
+ * Phone numbers are always "+375" followed by a 2-digit operator code and 7 digits,
+ * so they fit into a single integer: "+375291234567" -> 375291234567.
+ * Packed keys have a fixed number of digits, hence their numeric order matches string order.
+ */
+class PhoneNumber {
+public:
+  static constexpr v_int64 INVALID = 0;
+  static constexpr v_buff_size LENGTH = 13;
+
+  static v_int64 pack(const char* data, v_buff_size size) {
+    if (size != LENGTH || data[0] != '+') {
+      return INVALID;
+    }
+    v_int64 key = 0;
+    for (v_buff_size i = 1; i < size; i++) {
+      if (data[i] < '0' || data[i] > '9') {
+        return INVALID;
+      }
+      key = key * 10 + (data[i] - '0');
+    }
+    if (key / 1000000000 != 375) {
+      return INVALID;
+    }
+    switch (key / 10000000 % 100) {
+      case 29: case 25: case 44: case 33: case 17:
+        return key;
+      default:
+        return INVALID;
+    }
+  }
+
+  static v_int64 pack(const oatpp::String& phone) {
+    if (!phone) {
+      return INVALID;
+    }
+    return pack(phone->data(), phone->size());
+  }
+};
@@ -2,8 +2,8 @@
 
 #include "oatpp/core/macro/codegen.hpp"
 #include "oatpp/core/Types.hpp"
-#include "oatpp/web/protocol/http/Http.hpp"
-#include <regex>
+#include "phone_number.hpp"
+#include "result.hpp"
 
 #include OATPP_CODEGEN_BEGIN(DTO)
 
@@ -14,26 +14,29 @@ class ContactBaseDto : public oatpp::DTO {
   DTO_FIELD(String, phone_number, "phoneNumber");
   DTO_FIELD(String, address);
 
-  void validate() {
+  /**
+   * @return - packed phone number (see PhoneNumber) or the first validation error.
+   */
+  Result<v_int64> validate() const {
     if (!name || name->empty()) {
-      throw oatpp::web::protocol::http::HttpError(oatpp::web::protocol::http::Status::CODE_400, "Name is required");
+      return ErrorCode::NAME_REQUIRED;
     }
     if (name->size() > 50) {
-      throw oatpp::web::protocol::http::HttpError(oatpp::web::protocol::http::Status::CODE_400, "Name is too long (max 50)");
+      return ErrorCode::NAME_TOO_LONG;
     }
     if (!address || address->empty()) {
-      throw oatpp::web::protocol::http::HttpError(oatpp::web::protocol::http::Status::CODE_400, "Address is required");
+      return ErrorCode::ADDRESS_REQUIRED;
     }
     
     if (!phone_number || phone_number->empty()) {
-      throw oatpp::web::protocol::http::HttpError(oatpp::web::protocol::http::Status::CODE_400, "Phone number is required");
+      return ErrorCode::PHONE_REQUIRED;
     }
 
-    std::regex phone_regex(R"(^\+375(29|25|44|33|17)[0-9]{7}$)");
-    if (!std::regex_match(phone_number->c_str(), phone_regex)) {
-      throw oatpp::web::protocol::http::HttpError(oatpp::web::protocol::http::Status::CODE_400, 
-        "Invalid phone format. Required: +375XXXXXXXXX (Codes: 29, 25, 44, 33, 17)");
+    v_int64 phoneKey = PhoneNumber::pack(phone_number);
+    if (phoneKey == PhoneNumber::INVALID) {
+      return ErrorCode::PHONE_INVALID;
     }
+    return phoneKey;
   }
 };
 
@@ -0,0 +1,67 @@
+#pragma once
+
+#include "result.hpp"
+#include "dto/phonebook_dto.hpp"
+#include "oatpp/web/protocol/http/outgoing/Response.hpp"
+#include "oatpp/web/protocol/http/outgoing/BufferBody.hpp"
+#include "oatpp/core/data/mapping/ObjectMapper.hpp"
+
+#include <vector>
+
+/**
+ * Responses for expected errors (see ErrorCode).
+ * JSON bodies are serialized once at startup; building a response only wraps the shared body.
+ */
+class ErrorResponses {
+private:
+  typedef oatpp::web::protocol::http::outgoing::Response Response;
+  typedef oatpp::web::protocol::http::outgoing::BufferBody BufferBody;
+  typedef oatpp::web::protocol::http::Status Status;
+
+  struct Entry {
+    Status status;
+    oatpp::String body;
+  };
+
+  std::vector<Entry> m_entries;
+
+  static Entry describe(ErrorCode code) {
+    switch (code) {
+      case ErrorCode::NOT_FOUND:         return {Status::CODE_404, "Contact not found"};
+      case ErrorCode::DELETE_NOT_FOUND:  return {Status::CODE_404, "Cannot delete: Contact not found"};
+      case ErrorCode::PHONE_TAKEN:       return {Status::CODE_409, "Phone number already exists"};
+      case ErrorCode::NAME_REQUIRED:     return {Status::CODE_400, "Name is required"};
+      case ErrorCode::NAME_TOO_LONG:     return {Status::CODE_400, "Name is too long (max 50)"};
+      case ErrorCode::ADDRESS_REQUIRED:  return {Status::CODE_400, "Address is required"};
+      case ErrorCode::PHONE_REQUIRED:    return {Status::CODE_400, "Phone number is required"};
+      case ErrorCode::PHONE_INVALID:     return {Status::CODE_400, "Invalid phone format. Required: +375XXXXXXXXX (Codes: 29, 25, 44, 33, 17)"};
+      case ErrorCode::INVALID_SORT:      return {Status::CODE_400, "Invalid sort. Allowed: id, name, phone"};
+      case ErrorCode::INVALID_ORDER:     return {Status::CODE_400, "Invalid order. Allowed: asc, desc"};
+      case ErrorCode::INVALID_OFFSET:    return {Status::CODE_400, "Invalid offset"};
+      case ErrorCode::INVALID_LIMIT:     return {Status::CODE_400, "Invalid limit"};
+      case ErrorCode::INVALID_AFTER:     return {Status::CODE_400, "Invalid after: must be a cursor from X-Next-Cursor of the same sort"};
+      case ErrorCode::TOO_MANY_REQUESTS: return {Status::CODE_429, "Too many requests"};
+      case ErrorCode::BODY_REQUIRED:     return {Status::CODE_400, "Missing valid body parameter 'payload'"};
+      default:                           return {Status::CODE_500, "Internal server error"};
+    }
+  }
+
+public:
+  ErrorResponses(const std::shared_ptr<oatpp::data::mapping::ObjectMapper>& objectMapper) {
+    for (int i = 0; i < (int) ErrorCode::COUNT; i++) {
+      Entry entry = describe((ErrorCode) i);
+
+      auto errorDto = StatusDto::createShared();
+      errorDto->status = "ERROR";
+      errorDto->code = entry.status.code;
+      errorDto->message = entry.body;
+
+      m_entries.push_back({entry.status, objectMapper->writeToString(errorDto)});
+    }
+  }
+
+  std::shared_ptr<Response> createResponse(ErrorCode code) const {
+    const Entry& entry = m_entries[(int) code];
+    return Response::createShared(entry.status, BufferBody::createShared(entry.body, "application/json"));
+  }
+};
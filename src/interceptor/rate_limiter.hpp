@@ -0,0 +1,219 @@
+#pragma once
+
+#include "oatpp/core/Types.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+
+struct RateLimitRule {
+  std::string method;
+  // Exact path, or prefix when it ends with '*' (e.g. "/contacts/*").
+  std::string path;
+  v_int64 ratePerSecond;
+  v_int64 burst;
+
+  bool matches(const std::string& requestMethod, const std::string& requestPath) const {
+    if (requestMethod != method) {
+      return false;
+    }
+    if (!path.empty() && path.back() == '*') {
+      return requestPath.compare(0, path.size() - 1, path, 0, path.size() - 1) == 0;
+    }
+    return requestPath == path;
+  }
+};
+
+/**
+ * Fixed-size open-addressing table of token buckets keyed by client hash.
+ * Slots are claimed with a CAS on the key; each bucket is a single 64-bit word
+ * (refill timestamp in ms | milli-tokens) updated with a CAS loop, so acquiring never takes a lock.
+ * A slot whose bucket has refilled completely holds no state a fresh bucket wouldn't, so another
+ * client may take it over. When every slot within MAX_PROBES is busy, the client evicts the bucket with
+ * the most tokens (the oldest one on a tie): the owner loses the least, and drained clients - the ones
+ * the limit is for - are evicted last, so flooding the table with new keys doesn't reset them.
+ */
+class TokenBucketTable {
+public:
+  static constexpr v_uint32 MAX_PROBES = 16;
+  static constexpr v_uint32 TOKEN_BITS = 24;
+  static constexpr v_uint64 TOKEN_MASK = (v_uint64(1) << TOKEN_BITS) - 1;
+  static constexpr v_uint64 MILLI = 1000;
+  static constexpr v_uint64 EMPTY = 0;
+
+private:
+  struct Slot {
+    std::atomic<v_uint64> key{EMPTY};
+    std::atomic<v_uint64> state{0};
+  };
+
+  std::unique_ptr<Slot[]> m_slots;
+  v_uint64 m_mask;
+  v_uint64 m_ratePerSecond;
+  v_uint64 m_capacity; // in milli-tokens
+
+  /**
+   * splitmix64 finalizer, so that clients with similar std::hash values don't share probe chains.
+   */
+  static v_uint64 keyOf(v_uint64 clientHash) {
+    v_uint64 key = clientHash + 0x9E3779B97F4A7C15ULL;
+    key = (key ^ (key >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    key = (key ^ (key >> 27)) * 0x94D049BB133111EBULL;
+    key ^= key >> 31;
+    return key != EMPTY ? key : 1;
+  }
+
+  /**
+   * Milli-tokens the bucket holds at nowMs, refill included.
+   */
+  v_uint64 tokensAt(v_uint64 state, v_uint64 nowMs) const {
+    v_uint64 timestamp = state >> TOKEN_BITS;
+    v_uint64 tokens = state & TOKEN_MASK;
+    if (timestamp == 0) {
+      return m_capacity;
+    }
+    if (nowMs > timestamp) {
+      // rate tokens/s == rate milli-tokens/ms
+      v_uint64 elapsed = std::min<v_uint64>(nowMs - timestamp, m_capacity);
+      tokens = std::min<v_uint64>(tokens + elapsed * m_ratePerSecond, m_capacity);
+    }
+    return tokens;
+  }
+
+  /**
+   * Reset the bucket first: if its owner consumes in between, the CAS fails and the slot stays theirs.
+   */
+  bool takeOver(Slot& slot, v_uint64 owner, v_uint64 state, v_uint64 key) {
+    return slot.state.compare_exchange_strong(state, 0, std::memory_order_relaxed)
+        && slot.key.compare_exchange_strong(owner, key, std::memory_order_acq_rel);
+  }
+
+  Slot* findSlot(v_uint64 clientHash, v_uint64 nowMs) {
+    v_uint64 key = keyOf(clientHash);
+
+    // Slots can be taken over, so the client's slot may sit behind a free one: look it up first.
+    for (v_uint64 i = 0; i < MAX_PROBES; i++) {
+      Slot& slot = m_slots[(key + i) & m_mask];
+      if (slot.key.load(std::memory_order_acquire) == key) {
+        return &slot;
+      }
+    }
+
+    Slot* victim = nullptr;
+    v_uint64 victimKey = EMPTY;
+    v_uint64 victimState = 0;
+    v_uint64 victimTokens = 0;
+    for (v_uint64 i = 0; i < MAX_PROBES; i++) {
+      Slot& slot = m_slots[(key + i) & m_mask];
+      v_uint64 current = slot.key.load(std::memory_order_acquire);
+      if (current == key) {
+        return &slot;
+      }
+      if (current == EMPTY) {
+        if (slot.key.compare_exchange_strong(current, key, std::memory_order_acq_rel) || current == key) {
+          return &slot;
+        }
+        continue;
+      }
+      v_uint64 state = slot.state.load(std::memory_order_relaxed);
+      v_uint64 tokens = tokensAt(state, nowMs);
+      if (tokens >= m_capacity && takeOver(slot, current, state, key)) {
+        return &slot;
+      }
+      if (!victim || tokens > victimTokens
+          || (tokens == victimTokens && (state >> TOKEN_BITS) < (victimState >> TOKEN_BITS))) {
+        victim = &slot;
+        victimKey = current;
+        victimState = state;
+        victimTokens = tokens;
+      }
+    }
+
+    // Lost the race for the victim: share its bucket rather than retry, it is the fullest one in the window.
+    takeOver(*victim, victimKey, victimState, key);
+    return victim;
+  }
+
+public:
+  /**
+   * @param capacity - number of slots, rounded up to a power of two.
+   * @param ratePerSecond - tokens added per second.
+   * @param burst - bucket size in tokens, limited to TOKEN_MASK / 1000.
+   */
+  TokenBucketTable(v_uint64 capacity, v_int64 ratePerSecond, v_int64 burst)
+    : m_ratePerSecond((v_uint64) std::max<v_int64>(ratePerSecond, 0))
+    , m_capacity(std::min<v_uint64>((v_uint64) std::max<v_int64>(burst, 1) * MILLI, TOKEN_MASK))
+  {
+    v_uint64 size = 1;
+    while (size < capacity) size <<= 1;
+    m_slots.reset(new Slot[size]);
+    m_mask = size - 1;
+  }
+
+  /**
+   * Take one token from the client's bucket.
+   * @param clientHash - hash of the client identity.
+   * @param nowMs - monotonic time in milliseconds, must be > 0.
+   * @return - false if the client is out of tokens.
+   */
+  bool tryAcquire(v_uint64 clientHash, v_uint64 nowMs) {
+    Slot* slot = findSlot(clientHash, nowMs);
+    v_uint64 state = slot->state.load(std::memory_order_relaxed);
+    while (true) {
+      v_uint64 timestamp = state >> TOKEN_BITS;
+      v_uint64 tokens = state & TOKEN_MASK;
+
+      if (timestamp == 0) {
+        tokens = m_capacity;
+        timestamp = nowMs;
+      } else if (nowMs > timestamp) {
+        tokens = tokensAt(state, nowMs);
+        timestamp = nowMs;
+      }
+
+      bool allowed = tokens >= MILLI;
+      if (allowed) {
+        tokens -= MILLI;
+      }
+
+      v_uint64 newState = (timestamp << TOKEN_BITS) | tokens;
+      if (newState == state) {
+        return allowed;
+      }
+      if (slot->state.compare_exchange_weak(state, newState, std::memory_order_relaxed)) {
+        return allowed;
+      }
+    }
+  }
+};
+
+/**
+ * Token buckets for one rate-limited endpoint.
+ */
+class EndpointRateLimiter {
+private:
+  RateLimitRule m_rule;
+  TokenBucketTable m_buckets;
+  std::chrono::steady_clock::time_point m_epoch;
+
+public:
+  static constexpr v_uint64 DEFAULT_CAPACITY = 4096;
+
+  EndpointRateLimiter(const RateLimitRule& rule, v_uint64 capacity = DEFAULT_CAPACITY)
+    : m_rule(rule)
+    , m_buckets(capacity, rule.ratePerSecond, rule.burst)
+    , m_epoch(std::chrono::steady_clock::now())
+  {}
+
+  const RateLimitRule& getRule() const {
+    return m_rule;
+  }
+
+  bool tryAcquire(const std::string& clientKey) {
+    auto elapsed = std::chrono::steady_clock::now() - m_epoch;
+    v_uint64 nowMs = std::chrono::duration_cast<std::chrono::milliseconds>(elapsed).count() + 1;
+    return m_buckets.tryAcquire(std::hash<std::string>{}(clientKey), nowMs);
+  }
+};
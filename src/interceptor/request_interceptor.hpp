@@ -1,16 +1,75 @@
 #pragma once
 
+#include "error_responses.hpp"
+#include "interceptor/rate_limiter.hpp"
+#include "timing/request_timing.hpp"
 #include "oatpp/web/server/interceptor/RequestInterceptor.hpp"
 #include "oatpp/core/base/Environment.hpp"
 
+#include <memory>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
 
 class MyRequestInterceptor : public oatpp::web::server::interceptor::RequestInterceptor {
+private:
+  std::vector<std::unique_ptr<EndpointRateLimiter>> m_limiters;
+  std::shared_ptr<ErrorResponses> m_errorResponses;
+  std::unordered_set<std::string> m_apiKeys;
+
+  // Unknown API keys are ignored, otherwise a client could get a fresh bucket per request by rotating the header.
+  std::string clientKeyOf(const std::shared_ptr<IncomingRequest>& request) const {
+    auto apiKey = request->getHeader("X-API-Key");
+    if (apiKey && m_apiKeys.count(*apiKey) > 0) {
+      return "key:" + *apiKey;
+    }
+    auto address = request->getConnection()->getInputStreamContext().getProperties().get("peer_address");
+    return address ? "ip:" + *address : std::string("ip:unknown");
+  }
+
+  std::shared_ptr<OutgoingResponse> tooManyRequests() const {
+    auto response = m_errorResponses->createResponse(ErrorCode::TOO_MANY_REQUESTS);
+    response->putHeader("Retry-After", "1");
+    return response;
+  }
+
 public:
+  MyRequestInterceptor(const std::shared_ptr<ErrorResponses>& errorResponses,
+                       const std::vector<RateLimitRule>& rateLimits = {},
+                       const std::unordered_set<std::string>& apiKeys = {})
+    : m_errorResponses(errorResponses)
+    , m_apiKeys(apiKeys)
+  {
+    for (const auto& rule : rateLimits) {
+      m_limiters.push_back(std::make_unique<EndpointRateLimiter>(rule));
+    }
+  }
+
   std::shared_ptr<OutgoingResponse> intercept(const std::shared_ptr<IncomingRequest>& request) override {
+    RequestTiming::current().begin();
+
     OATPP_LOGD("API_LOG", "Incoming Request: [%s] %s", 
                request->getStartingLine().method.toString()->c_str(),
                request->getStartingLine().path.toString()->c_str());
 
+    if (m_limiters.empty()) {
+      return nullptr;
+    }
+
+    std::string method = request->getStartingLine().method.std_str();
+    std::string path = request->getStartingLine().path.std_str();
+    path = path.substr(0, path.find('?'));
+
+    for (auto& limiter : m_limiters) {
+      if (limiter->getRule().matches(method, path)) {
+        if (!limiter->tryAcquire(clientKeyOf(request))) {
+          return tooManyRequests();
+        }
+        break;
+      }
+    }
+
     return nullptr; 
   }
-};
\ No newline at end of file
+};
@@ -0,0 +1,65 @@
+#pragma once
+
+#include "timing/request_timing.hpp"
+#include "oatpp/web/server/interceptor/ResponseInterceptor.hpp"
+
+#include <algorithm>
+#include <memory>
+#include <string>
+
+/**
+ * Closes the stage breakdown started by MyRequestInterceptor: feeds slow requests into SlowRequestLog
+ * and optionally reports the breakdown in a Server-Timing header.
+ */
+class RequestTimingInterceptor : public oatpp::web::server::interceptor::ResponseInterceptor {
+private:
+  std::shared_ptr<SlowRequestLog> m_slowRequests;
+  bool m_emitServerTiming;
+
+  // "METHOD /path" without the query string and with path parameters replaced by their names,
+  // e.g. "GET /contacts/by-phone/{phone}", so the log never holds caller data.
+  static std::string routeOf(const std::shared_ptr<IncomingRequest>& request) {
+    std::string path = request->getStartingLine().path.std_str();
+    path = path.substr(0, path.find('?'));
+    const auto& variables = request->getPathVariables().getVariables();
+
+    std::string route = request->getStartingLine().method.std_str() + " ";
+    size_t position = 0;
+    while (position < path.size()) {
+      if (path[position] == '/') {
+        route += '/';
+        position++;
+        continue;
+      }
+      size_t end = std::min(path.find('/', position), path.size());
+      std::string segment = path.substr(position, end - position);
+      for (const auto& variable : variables) {
+        if (variable.second.std_str() == segment) {
+          segment = "{" + variable.first.std_str() + "}";
+          break;
+        }
+      }
+      route += segment;
+      position = end;
+    }
+    return route;
+  }
+
+public:
+  RequestTimingInterceptor(const std::shared_ptr<SlowRequestLog>& slowRequests, bool emitServerTiming)
+    : m_slowRequests(slowRequests)
+    , m_emitServerTiming(emitServerTiming)
+  {}
+
+  std::shared_ptr<OutgoingResponse> intercept(const std::shared_ptr<IncomingRequest>& request,
+                                              const std::shared_ptr<OutgoingResponse>& response) override {
+    const RequestTiming& timing = RequestTiming::current();
+    if (m_slowRequests->isSlow(timing)) {
+      m_slowRequests->record(routeOf(request), timing);
+    }
+    if (m_emitServerTiming) {
+      response->putHeader("Server-Timing", timing.toServerTiming());
+    }
+    return response;
+  }
+};
@@ -1,14 +1,34 @@
 #pragma once
 
 #include "dto/phonebook_dto.hpp"
+#include "result.hpp"
+
+enum class ContactSortField { ID, NAME, PHONE };
+enum class SortOrder { ASC, DESC };
+
+// Position in a sorted listing: the sort key and id of the last contact of the previous page.
+// It carries the keys themselves, so the next page is found even if that contact was deleted or changed since.
+struct ContactCursor {
+    v_int64 id = 0;
+    std::string name;  // ContactSortField::NAME
+    v_int64 phone = 0; // ContactSortField::PHONE, packed
+};
 
 class IPhonebookRepository {
 public:
     virtual ~IPhonebookRepository() = default;
 
-    virtual oatpp::Object<ContactDto> save(const oatpp::Object<ContactDto>& entry) = 0;
+    // Inserts when entry->id is unset, otherwise replaces the stored entry.
+    // phoneKey is entry->phone_number packed by the caller's validation, see PhoneNumber.
+    // Fails with PHONE_TAKEN if another contact has the same phone, NOT_FOUND if the id is unknown.
+    virtual Result<oatpp::Object<ContactDto>> save(const oatpp::Object<ContactDto>& entry, v_int64 phoneKey) = 0;
     virtual oatpp::Object<ContactDto> get_by_id(v_int64 id) = 0;
+    // phoneKey is a packed phone number, see PhoneNumber
+    virtual oatpp::Object<ContactDto> get_by_phone(v_int64 phoneKey) = 0;
     virtual oatpp::List<oatpp::Object<ContactDto>> get_all() = 0;
+    // Contacts ordered by (field, id). With after set the page starts right behind that position,
+    // offset is applied from there. limit < 0 means "till the end".
+    virtual oatpp::List<oatpp::Object<ContactDto>> get_sorted(ContactSortField field, SortOrder order, const ContactCursor* after,
+                                                              v_int64 offset, v_int64 limit) = 0;
     virtual bool remove(v_int64 id) = 0;
-    virtual bool isPhoneNumberTaken(const oatpp::String& phoneNumber, const oatpp::Int64& skipId = nullptr) = 0;
-};
\ No newline at end of file
+};
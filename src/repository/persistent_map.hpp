@@ -0,0 +1,234 @@
+#pragma once
+
+#include "oatpp/core/Types.hpp"
+
+#include <memory>
+#include <utility>
+#include <vector>
+
+/**
+ * Immutable ordered map from unsigned 64-bit keys to values.
+ * Bitmap-compressed radix trie, 32-way, over the key bits themselves (no hashing), most significant chunk first,
+ * so in-order traversal yields ascending keys. The trie grows in height only as large as the biggest key needs.
+ * Every modification copies the path to the changed leaf and shares the rest with the previous version,
+ * so old versions stay valid and can be read from any thread without locking.
+ * Nodes carry subtree sizes, which lets ordered traversal skip an offset and rank() count smaller keys
+ * in O(height * 32).
+ */
+template<class V>
+class PersistentMap {
+private:
+  static constexpr v_uint32 BITS = 5;
+  static constexpr v_uint32 MASK = (1 << BITS) - 1;
+  static constexpr v_uint32 MAX_HEIGHT = (64 + BITS - 1) / BITS;
+
+  struct Node {
+    v_uint32 bitmap = 0;
+    v_uint64 count = 0;
+    std::vector<std::shared_ptr<const Node>> children; // inner levels
+    std::vector<V> values;                            // level 0
+  };
+
+  std::shared_ptr<const Node> m_root;
+  v_uint32 m_height = 1;
+
+  static v_uint32 chunkOf(v_uint64 key, v_uint32 level) {
+    return (v_uint32) (key >> (level * BITS)) & MASK;
+  }
+
+  static v_uint32 indexOf(v_uint32 bitmap, v_uint32 chunk) {
+    return (v_uint32) __builtin_popcount(bitmap & ((v_uint32(1) << chunk) - 1));
+  }
+
+  static v_uint32 heightFor(v_uint64 key) {
+    v_uint32 height = 1;
+    while (height < MAX_HEIGHT && (key >> (height * BITS)) != 0) height++;
+    return height;
+  }
+
+  static std::shared_ptr<const Node> setIn(const Node* node, v_uint32 level, v_uint64 key, const V& value, bool& inserted) {
+    auto copy = node ? std::make_shared<Node>(*node) : std::make_shared<Node>();
+    v_uint32 chunk = chunkOf(key, level);
+    v_uint32 bit = v_uint32(1) << chunk;
+    v_uint32 index = indexOf(copy->bitmap, chunk);
+    bool present = (copy->bitmap & bit) != 0;
+
+    if (level == 0) {
+      if (present) {
+        copy->values[index] = value;
+      } else {
+        copy->values.insert(copy->values.begin() + index, value);
+      }
+      inserted = !present;
+    } else {
+      auto child = setIn(present ? copy->children[index].get() : nullptr, level - 1, key, value, inserted);
+      if (present) {
+        copy->children[index] = std::move(child);
+      } else {
+        copy->children.insert(copy->children.begin() + index, std::move(child));
+      }
+    }
+
+    copy->bitmap |= bit;
+    if (inserted) copy->count++;
+    return copy;
+  }
+
+  static std::shared_ptr<const Node> eraseIn(const std::shared_ptr<const Node>& node, v_uint32 level, v_uint64 key, bool& removed) {
+    v_uint32 chunk = chunkOf(key, level);
+    v_uint32 bit = v_uint32(1) << chunk;
+    if (!(node->bitmap & bit)) {
+      removed = false;
+      return node;
+    }
+    v_uint32 index = indexOf(node->bitmap, chunk);
+
+    std::shared_ptr<const Node> child;
+    if (level > 0) {
+      child = eraseIn(node->children[index], level - 1, key, removed);
+      if (!removed) {
+        return node;
+      }
+    }
+    removed = true;
+    if (node->count == 1) {
+      return nullptr;
+    }
+
+    auto copy = std::make_shared<Node>(*node);
+    copy->count--;
+    if (level > 0 && child) {
+      copy->children[index] = std::move(child);
+      return copy;
+    }
+    if (level > 0) {
+      copy->children.erase(copy->children.begin() + index);
+    } else {
+      copy->values.erase(copy->values.begin() + index);
+    }
+    copy->bitmap &= ~bit;
+    return copy;
+  }
+
+  template<class F>
+  static bool visit(const Node* node, v_uint32 level, v_uint64 prefix, bool reverse, v_uint64& offset, F& func) {
+    if (offset >= node->count) {
+      offset -= node->count;
+      return true;
+    }
+    v_uint32 bits = node->bitmap;
+    v_uint32 index = reverse ? (v_uint32) __builtin_popcount(bits) : 0;
+    while (bits) {
+      v_uint32 chunk = reverse ? 31 - (v_uint32) __builtin_clz(bits) : (v_uint32) __builtin_ctz(bits);
+      bits &= ~(v_uint32(1) << chunk);
+      v_uint32 position = reverse ? --index : index++;
+      v_uint64 key = (prefix << BITS) | chunk;
+
+      if (level == 0) {
+        if (offset > 0) {
+          offset--;
+          continue;
+        }
+        if (!func(key, node->values[position])) return false;
+      } else if (!visit(node->children[position].get(), level - 1, key, reverse, offset, func)) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+public:
+
+  v_uint64 size() const {
+    return m_root ? m_root->count : 0;
+  }
+
+  const V* find(v_uint64 key) const {
+    if (!m_root || heightFor(key) > m_height) {
+      return nullptr;
+    }
+    const Node* node = m_root.get();
+    for (v_uint32 level = m_height - 1; ; level--) {
+      v_uint32 chunk = chunkOf(key, level);
+      if (!(node->bitmap & (v_uint32(1) << chunk))) {
+        return nullptr;
+      }
+      v_uint32 index = indexOf(node->bitmap, chunk);
+      if (level == 0) {
+        return &node->values[index];
+      }
+      node = node->children[index].get();
+    }
+  }
+
+  /**
+   * Number of keys less than key.
+   */
+  v_uint64 rank(v_uint64 key) const {
+    if (!m_root) {
+      return 0;
+    }
+    if (heightFor(key) > m_height) {
+      return m_root->count;
+    }
+    v_uint64 result = 0;
+    const Node* node = m_root.get();
+    for (v_uint32 level = m_height - 1; ; level--) {
+      v_uint32 chunk = chunkOf(key, level);
+      v_uint32 index = indexOf(node->bitmap, chunk);
+      if (level == 0) {
+        return result + index;
+      }
+      for (v_uint32 i = 0; i < index; i++) {
+        result += node->children[i]->count;
+      }
+      if (!(node->bitmap & (v_uint32(1) << chunk))) {
+        return result;
+      }
+      node = node->children[index].get();
+    }
+  }
+
+  PersistentMap set(v_uint64 key, const V& value) const {
+    PersistentMap result = *this;
+    v_uint32 height = heightFor(key);
+    // Taller trie: the current root becomes the 0-th child of each new level.
+    while (result.m_height < height) {
+      if (result.m_root) {
+        auto parent = std::make_shared<Node>();
+        parent->bitmap = 1;
+        parent->count = result.m_root->count;
+        parent->children.push_back(result.m_root);
+        result.m_root = parent;
+      }
+      result.m_height++;
+    }
+    bool inserted = false;
+    result.m_root = setIn(result.m_root.get(), result.m_height - 1, key, value, inserted);
+    return result;
+  }
+
+  PersistentMap erase(v_uint64 key) const {
+    if (!m_root || heightFor(key) > m_height) {
+      return *this;
+    }
+    PersistentMap result = *this;
+    bool removed = false;
+    result.m_root = eraseIn(m_root, m_height - 1, key, removed);
+    return result;
+  }
+
+  /**
+   * Ordered traversal.
+   * @param reverse - descending keys.
+   * @param offset - number of entries to skip.
+   * @param func - `bool(v_uint64 key, const V& value)`, return false to stop.
+   */
+  template<class F>
+  void forEach(bool reverse, v_uint64 offset, F&& func) const {
+    if (m_root) {
+      visit(m_root.get(), m_height - 1, 0, reverse, offset, func);
+    }
+  }
+
+};
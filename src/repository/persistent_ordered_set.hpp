@@ -0,0 +1,191 @@
+#pragma once
+
+#include "oatpp/core/Types.hpp"
+
+#include <functional>
+#include <memory>
+
+/**
+ * Immutable ordered set, a treap with path copying.
+ * Node priorities are derived from the key hash, so the shape doesn't depend on insertion order and the
+ * expected depth is O(log n). Every modification copies only the nodes on the changed paths and shares
+ * the rest with the previous version, so old versions stay valid and can be read from any thread.
+ * Nodes carry subtree sizes: rank() and skipping an offset in forEach() are O(log n).
+ * @tparam K - key type, ordered by operator<.
+ * @tparam Hash - hash of K, only used for node priorities.
+ */
+template<class K, class Hash = std::hash<K>>
+class PersistentOrderedSet {
+private:
+  struct Node;
+  typedef std::shared_ptr<const Node> NodePtr;
+
+  struct Node {
+    K key;
+    v_uint64 priority;
+    v_uint64 count;
+    NodePtr left;
+    NodePtr right;
+  };
+
+  NodePtr m_root;
+
+  static v_uint64 countOf(const NodePtr& node) {
+    return node ? node->count : 0;
+  }
+
+  static v_uint64 priorityOf(const K& key) {
+    // splitmix64 finalizer, spreads sequential hashes (e.g. ids) over the whole range
+    v_uint64 value = (v_uint64) Hash{}(key) + 0x9E3779B97F4A7C15ULL;
+    value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    value = (value ^ (value >> 27)) * 0x94D049BB133111EBULL;
+    return value ^ (value >> 31);
+  }
+
+  static NodePtr make(const Node& source, NodePtr left, NodePtr right) {
+    return std::make_shared<Node>(Node{source.key, source.priority, 1 + countOf(left) + countOf(right),
+                                       std::move(left), std::move(right)});
+  }
+
+  // Keys < key go to less, the rest to notLess.
+  static void split(const NodePtr& node, const K& key, NodePtr& less, NodePtr& notLess) {
+    if (!node) {
+      less = nullptr;
+      notLess = nullptr;
+      return;
+    }
+    if (node->key < key) {
+      NodePtr rightLess;
+      split(node->right, key, rightLess, notLess);
+      less = make(*node, node->left, rightLess);
+    } else {
+      NodePtr leftNotLess;
+      split(node->left, key, less, leftNotLess);
+      notLess = make(*node, leftNotLess, node->right);
+    }
+  }
+
+  // Every key in a is less than every key in b.
+  static NodePtr merge(const NodePtr& a, const NodePtr& b) {
+    if (!a) return b;
+    if (!b) return a;
+    if (a->priority > b->priority) {
+      return make(*a, a->left, merge(a->right, b));
+    }
+    return make(*b, merge(a, b->left), b->right);
+  }
+
+  static NodePtr insertIn(const NodePtr& node, const Node& leaf) {
+    if (!node || leaf.priority > node->priority) {
+      NodePtr less, notLess;
+      split(node, leaf.key, less, notLess);
+      return make(leaf, less, notLess);
+    }
+    if (leaf.key < node->key) {
+      return make(*node, insertIn(node->left, leaf), node->right);
+    }
+    return make(*node, node->left, insertIn(node->right, leaf));
+  }
+
+  static NodePtr eraseIn(const NodePtr& node, const K& key, bool& removed) {
+    if (!node) {
+      removed = false;
+      return node;
+    }
+    if (key < node->key) {
+      NodePtr left = eraseIn(node->left, key, removed);
+      return removed ? make(*node, left, node->right) : node;
+    }
+    if (node->key < key) {
+      NodePtr right = eraseIn(node->right, key, removed);
+      return removed ? make(*node, node->left, right) : node;
+    }
+    removed = true;
+    return merge(node->left, node->right);
+  }
+
+  template<class F>
+  static bool visit(const Node* node, bool reverse, v_uint64& offset, F& func) {
+    if (!node) {
+      return true;
+    }
+    if (offset >= node->count) {
+      offset -= node->count;
+      return true;
+    }
+    if (!visit(reverse ? node->right.get() : node->left.get(), reverse, offset, func)) {
+      return false;
+    }
+    if (offset > 0) {
+      offset--;
+    } else if (!func(node->key)) {
+      return false;
+    }
+    return visit(reverse ? node->left.get() : node->right.get(), reverse, offset, func);
+  }
+
+public:
+
+  v_uint64 size() const {
+    return countOf(m_root);
+  }
+
+  bool contains(const K& key) const {
+    const Node* node = m_root.get();
+    while (node) {
+      if (key < node->key) {
+        node = node->left.get();
+      } else if (node->key < key) {
+        node = node->right.get();
+      } else {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  /**
+   * Number of keys less than key.
+   */
+  v_uint64 rank(const K& key) const {
+    v_uint64 result = 0;
+    const Node* node = m_root.get();
+    while (node) {
+      if (node->key < key) {
+        result += countOf(node->left) + 1;
+        node = node->right.get();
+      } else {
+        node = node->left.get();
+      }
+    }
+    return result;
+  }
+
+  PersistentOrderedSet insert(const K& key) const {
+    if (contains(key)) {
+      return *this;
+    }
+    PersistentOrderedSet result;
+    result.m_root = insertIn(m_root, Node{key, priorityOf(key), 1, nullptr, nullptr});
+    return result;
+  }
+
+  PersistentOrderedSet erase(const K& key) const {
+    PersistentOrderedSet result;
+    bool removed = false;
+    result.m_root = eraseIn(m_root, key, removed);
+    return result;
+  }
+
+  /**
+   * Ordered traversal.
+   * @param reverse - descending keys.
+   * @param offset - number of keys to skip.
+   * @param func - `bool(const K& key)`, return false to stop.
+   */
+  template<class F>
+  void forEach(bool reverse, v_uint64 offset, F&& func) const {
+    visit(m_root.get(), reverse, offset, func);
+  }
+
+};
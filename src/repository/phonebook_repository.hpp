@@ -1,12 +1,34 @@
 #pragma once
 
 #include "iphonebook_repository.hpp"
+#include "timing/request_timing.hpp"
+#include <iterator>
+#include <map>
+#include <set>
+#include <string>
 #include <unordered_map>
+#include <utility>
 #include <mutex>
 
 class PhonebookRepository : public IPhonebookRepository {
 private:
-    std::unordered_map<v_int64, oatpp::Object<ContactDto>> database_;
+    typedef std::set<std::pair<std::string, v_int64>> NameIndex;
+    typedef std::set<std::pair<v_int64, v_int64>> PhoneIndex;
+
+    struct IndexedKeys {
+        std::string name;
+        v_int64 phone;
+    };
+
+    // Ordered by id, so id sorting is a plain walk of the map.
+    std::map<v_int64, oatpp::Object<ContactDto>> database_;
+    // Secondary indexes are updated on every write, (key, id) pairs keep duplicates and give a stable order.
+    NameIndex name_index_;
+    PhoneIndex phone_index_;
+    // Packed phone -> id, uniqueness is checked in save().
+    std::unordered_map<v_int64, v_int64> phone_ids_;
+    // Keys the entry is indexed with, so replacing or removing it doesn't re-parse the stored phone number.
+    std::unordered_map<v_int64, IndexedKeys> indexed_keys_;
     v_int64 id_counter_ = 0;
     std::mutex m_mutex;
 
@@ -17,54 +39,132 @@ public:
         addTestData("Kristina", "+375251234567", "Mogilev, Belarus");
     }
 
-    oatpp::Object<ContactDto> save(const oatpp::Object<ContactDto>& entry) override {
-        std::lock_guard<std::mutex> lock(m_mutex);
-        if (!entry->id || entry->id == 0) {
+    Result<oatpp::Object<ContactDto>> save(const oatpp::Object<ContactDto>& entry, v_int64 phoneKey) override {
+        auto lock = acquireLock();
+        StageTimer timer(RequestStage::REPOSITORY);
+        bool isNew = !entry->id || entry->id == 0;
+        if (!isNew && database_.find(entry->id) == database_.end()) {
+            return ErrorCode::NOT_FOUND;
+        }
+
+        auto phoneOwner = phone_ids_.find(phoneKey);
+        if (phoneOwner != phone_ids_.end() && (isNew || phoneOwner->second != entry->id)) {
+            return ErrorCode::PHONE_TAKEN;
+        }
+
+        if (isNew) {
             entry->id = ++id_counter_;
         }
         database_[entry->id] = entry;
+        reindex(entry, phoneKey);
         return entry;
     }
 
     oatpp::Object<ContactDto> get_by_id(v_int64 id) override {
-        std::lock_guard<std::mutex> lock(m_mutex);
+        auto lock = acquireLock();
+        StageTimer timer(RequestStage::REPOSITORY);
         auto it = database_.find(id);
         if (it != database_.end()) return it->second;
         return nullptr;
     }
 
+    oatpp::Object<ContactDto> get_by_phone(v_int64 phoneKey) override {
+        auto lock = acquireLock();
+        StageTimer timer(RequestStage::REPOSITORY);
+        auto it = phone_ids_.find(phoneKey);
+        if (it != phone_ids_.end()) return database_.at(it->second);
+        return nullptr;
+    }
+
     oatpp::List<oatpp::Object<ContactDto>> get_all() override {
-        std::lock_guard<std::mutex> lock(m_mutex);
-        auto list = oatpp::List<oatpp::Object<ContactDto>>::createShared();
-        for (const auto& pair : database_) {
-            list->push_back(pair.second);
+        return get_sorted(ContactSortField::ID, SortOrder::ASC, nullptr, 0, -1);
+    }
+
+    oatpp::List<oatpp::Object<ContactDto>> get_sorted(ContactSortField field, SortOrder order, const ContactCursor* after,
+                                                      v_int64 offset, v_int64 limit) override {
+        auto lock = acquireLock();
+        StageTimer timer(RequestStage::REPOSITORY);
+        auto byId = [](const std::pair<const v_int64, oatpp::Object<ContactDto>>& pair) { return pair.second; };
+        auto byName = [this](const std::pair<std::string, v_int64>& key) { return database_.at(key.second); };
+        auto byPhone = [this](const std::pair<v_int64, v_int64>& key) { return database_.at(key.second); };
+        bool ascending = order == SortOrder::ASC;
+
+        switch (field) {
+            case ContactSortField::NAME: {
+                NameIndex::key_type key = after ? NameIndex::key_type(after->name, after->id) : NameIndex::key_type();
+                return collectPage(name_index_, after ? &key : nullptr, ascending, offset, limit, byName);
+            }
+            case ContactSortField::PHONE: {
+                PhoneIndex::key_type key = after ? PhoneIndex::key_type(after->phone, after->id) : PhoneIndex::key_type();
+                return collectPage(phone_index_, after ? &key : nullptr, ascending, offset, limit, byPhone);
+            }
+            case ContactSortField::ID:
+            default:
+                return collectPage(database_, after ? &after->id : nullptr, ascending, offset, limit, byId);
         }
-        return list;
     }
 
     bool remove(v_int64 id) override {
-        std::lock_guard<std::mutex> lock(m_mutex);
+        auto lock = acquireLock();
+        StageTimer timer(RequestStage::REPOSITORY);
+        unindex(id);
         return database_.erase(id) > 0;
     }
 
-    bool isPhoneNumberTaken(const oatpp::String& phoneNumber, const oatpp::Int64& skipId) override {
-        std::lock_guard<std::mutex> lock(m_mutex);
-        
-        for (const auto& pair : database_) {
-            auto id = pair.first;
-            auto contact = pair.second;
-            if (skipId && id == *skipId) {
-                continue;
-            }
-            
-            if (contact->phone_number == phoneNumber) {
-                return true;
-            }
+private:
+    std::unique_lock<std::mutex> acquireLock() {
+        StageTimer timer(RequestStage::LOCK_WAIT);
+        return std::unique_lock<std::mutex>(m_mutex);
+    }
+
+    // Entries behind `after` are found with a tree lookup, only offset is walked linearly.
+    template<class Container, class Resolve>
+    static oatpp::List<oatpp::Object<ContactDto>> collectPage(const Container& container, const typename Container::key_type* after,
+                                                              bool ascending, v_int64 offset, v_int64 limit, Resolve resolve) {
+        if (ascending) {
+            auto begin = after ? container.upper_bound(*after) : container.begin();
+            return collectPage(begin, container.end(), offset, limit, resolve);
         }
-        return false;
+        auto begin = after ? std::make_reverse_iterator(container.lower_bound(*after)) : container.rbegin();
+        return collectPage(begin, container.rend(), offset, limit, resolve);
+    }
+
+    template<class Iterator, class Resolve>
+    static oatpp::List<oatpp::Object<ContactDto>> collectPage(Iterator it, Iterator end, v_int64 offset, v_int64 limit,
+                                                              Resolve resolve) {
+        auto list = oatpp::List<oatpp::Object<ContactDto>>::createShared();
+        for (; it != end && offset > 0; ++it, --offset) {}
+        for (; it != end && limit != 0; ++it, --limit) {
+            list->push_back(resolve(*it));
+        }
+        return list;
+    }
+
+    static std::string keyOf(const oatpp::String& value) {
+        return value ? *value : std::string();
+    }
+
+    void reindex(const oatpp::Object<ContactDto>& entry, v_int64 phoneKey) {
+        unindex(entry->id);
+        IndexedKeys keys{keyOf(entry->name), phoneKey};
+        name_index_.emplace(keys.name, entry->id);
+        phone_index_.emplace(keys.phone, entry->id);
+        phone_ids_[keys.phone] = entry->id;
+        indexed_keys_[entry->id] = std::move(keys);
+    }
+
+    void unindex(v_int64 id) {
+        auto it = indexed_keys_.find(id);
+        if (it == indexed_keys_.end()) return;
+        name_index_.erase({it->second.name, id});
+        phone_index_.erase({it->second.phone, id});
+        auto phoneIt = phone_ids_.find(it->second.phone);
+        if (phoneIt != phone_ids_.end() && phoneIt->second == id) {
+            phone_ids_.erase(phoneIt);
+        }
+        indexed_keys_.erase(it);
     }
 
-private:
     void addTestData(const char* name, const char* phone, const char* address) {
         auto dto = ContactDto::createShared();
         dto->name = name;
@@ -72,5 +172,6 @@ private:
         dto->address = address;
         dto->id = ++id_counter_;
         database_[dto->id] = dto;
+        reindex(dto, PhoneNumber::pack(dto->phone_number));
     }
-};
\ No newline at end of file
+};
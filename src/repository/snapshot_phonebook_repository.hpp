@@ -0,0 +1,211 @@
+#pragma once
+
+#include "iphonebook_repository.hpp"
+#include "persistent_map.hpp"
+#include "persistent_ordered_set.hpp"
+#include "timing/request_timing.hpp"
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+
+/**
+ * MVCC repository: the whole phonebook is an immutable Snapshot behind a shared_ptr.
+ * Readers copy the current pointer and then work on that version without any repository lock, so full
+ * listings never stall writers. The copy goes through std::atomic_load / std::atomic_store, which are not
+ * lock-free in libstdc++ (a small pool of spinlocks guards the refcount update), so readers and writers only
+ * contend for that pointer copy, not for the duration of a scan.
+ * Writers are serialized by m_writeMutex, build the next version by path-copying PersistentMap and
+ * PersistentOrderedSet nodes and publish it. Old versions are reclaimed by reference counting once the
+ * last reader drops them.
+ * Saved entries are shared between versions and must not be modified in place afterwards.
+ */
+class SnapshotPhonebookRepository : public IPhonebookRepository {
+private:
+    typedef std::pair<std::string, v_int64> NameKey;
+
+    // (name, id) pairs are unique by id, which is all the treap priorities need.
+    struct NameKeyHash {
+        size_t operator()(const NameKey& key) const {
+            return std::hash<v_int64>{}(key.second);
+        }
+    };
+
+    struct StoredContact {
+        oatpp::Object<ContactDto> contact;
+        v_int64 phoneKey; // packed phone the contact is indexed with
+    };
+
+    struct Snapshot {
+        PersistentMap<StoredContact> contacts; // by id
+        PersistentMap<v_int64> phones;         // packed phone -> id
+        PersistentOrderedSet<NameKey, NameKeyHash> names;
+        v_int64 idCounter = 0;
+    };
+
+    std::shared_ptr<const Snapshot> m_snapshot;
+    std::mutex m_writeMutex;
+
+public:
+    SnapshotPhonebookRepository()
+        : m_snapshot(std::make_shared<Snapshot>())
+    {
+        addTestData("Nikita", "+375291112233", "Minsk, Belarus");
+        addTestData("Artur", "+375447778899", "Gomel, Belarus");
+        addTestData("Kristina", "+375251234567", "Mogilev, Belarus");
+    }
+
+    Result<oatpp::Object<ContactDto>> save(const oatpp::Object<ContactDto>& entry, v_int64 phoneKey) override {
+        auto lock = acquireWriteLock();
+        StageTimer timer(RequestStage::REPOSITORY);
+        auto current = snapshot();
+        bool isNew = !entry->id || entry->id == 0;
+
+        const StoredContact* previous = nullptr;
+        if (!isNew) {
+            previous = current->contacts.find(entry->id);
+            if (!previous) {
+                return ErrorCode::NOT_FOUND;
+            }
+        }
+
+        const v_int64* phoneOwner = current->phones.find(phoneKey);
+        if (phoneOwner && (isNew || *phoneOwner != entry->id)) {
+            return ErrorCode::PHONE_TAKEN;
+        }
+
+        auto next = std::make_shared<Snapshot>(*current);
+        if (isNew) {
+            entry->id = ++next->idCounter;
+        } else {
+            next->phones = next->phones.erase(previous->phoneKey);
+            next->names = next->names.erase(NameKey(keyOf(previous->contact->name), entry->id));
+        }
+        next->contacts = next->contacts.set(entry->id, StoredContact{entry, phoneKey});
+        next->phones = next->phones.set(phoneKey, entry->id);
+        next->names = next->names.insert(NameKey(keyOf(entry->name), entry->id));
+        publish(next);
+        return entry;
+    }
+
+    oatpp::Object<ContactDto> get_by_id(v_int64 id) override {
+        StageTimer timer(RequestStage::REPOSITORY);
+        auto current = snapshot();
+        auto stored = current->contacts.find(id);
+        return stored ? stored->contact : nullptr;
+    }
+
+    oatpp::Object<ContactDto> get_by_phone(v_int64 phoneKey) override {
+        StageTimer timer(RequestStage::REPOSITORY);
+        auto current = snapshot();
+        auto id = current->phones.find(phoneKey);
+        return id ? current->contacts.find(*id)->contact : nullptr;
+    }
+
+    oatpp::List<oatpp::Object<ContactDto>> get_all() override {
+        return get_sorted(ContactSortField::ID, SortOrder::ASC, nullptr, 0, -1);
+    }
+
+    oatpp::List<oatpp::Object<ContactDto>> get_sorted(ContactSortField field, SortOrder order, const ContactCursor* after,
+                                                      v_int64 offset, v_int64 limit) override {
+        StageTimer timer(RequestStage::REPOSITORY);
+        auto current = snapshot();
+        auto list = oatpp::List<oatpp::Object<ContactDto>>::createShared();
+        bool reverse = order == SortOrder::DESC;
+
+        // skip = entries up to and including the cursor position in traversal order, found with rank()
+        v_uint64 skip = offset;
+        switch (field) {
+            case ContactSortField::PHONE:
+                if (after) {
+                    // phones are unique, (phone, id) order only matters if the phone has been taken by another contact
+                    const v_int64* owner = current->phones.find(after->phone);
+                    skip += reverse
+                        ? current->phones.size() - current->phones.rank(after->phone) - (owner && *owner < after->id)
+                        : current->phones.rank(after->phone) + (owner && *owner <= after->id);
+                }
+                current->phones.forEach(reverse, skip, [&](v_uint64, v_int64 id) {
+                    if (limit == 0) return false;
+                    list->push_back(current->contacts.find(id)->contact);
+                    --limit;
+                    return true;
+                });
+                break;
+            case ContactSortField::NAME:
+                if (after) {
+                    NameKey key(after->name, after->id);
+                    skip += reverse
+                        ? current->names.size() - current->names.rank(key)
+                        : current->names.rank(key) + current->names.contains(key);
+                }
+                current->names.forEach(reverse, skip, [&](const NameKey& key) {
+                    if (limit == 0) return false;
+                    list->push_back(current->contacts.find(key.second)->contact);
+                    --limit;
+                    return true;
+                });
+                break;
+            case ContactSortField::ID:
+            default:
+                if (after) {
+                    skip += reverse
+                        ? current->contacts.size() - current->contacts.rank(after->id)
+                        : current->contacts.rank(after->id + 1);
+                }
+                current->contacts.forEach(reverse, skip, [&](v_uint64, const StoredContact& stored) {
+                    if (limit == 0) return false;
+                    list->push_back(stored.contact);
+                    --limit;
+                    return true;
+                });
+                break;
+        }
+        return list;
+    }
+
+    bool remove(v_int64 id) override {
+        auto lock = acquireWriteLock();
+        StageTimer timer(RequestStage::REPOSITORY);
+        auto current = snapshot();
+        auto stored = current->contacts.find(id);
+        if (!stored) {
+            return false;
+        }
+
+        auto next = std::make_shared<Snapshot>(*current);
+        next->phones = next->phones.erase(stored->phoneKey);
+        next->names = next->names.erase(NameKey(keyOf(stored->contact->name), id));
+        next->contacts = next->contacts.erase(id);
+        publish(next);
+        return true;
+    }
+
+private:
+    std::shared_ptr<const Snapshot> snapshot() const {
+        return std::atomic_load(&m_snapshot);
+    }
+
+    void publish(const std::shared_ptr<const Snapshot>& next) {
+        std::atomic_store(&m_snapshot, next);
+    }
+
+    std::unique_lock<std::mutex> acquireWriteLock() {
+        StageTimer timer(RequestStage::LOCK_WAIT);
+        return std::unique_lock<std::mutex>(m_writeMutex);
+    }
+
+    static const std::string& keyOf(const oatpp::String& value) {
+        static const std::string empty;
+        return value ? *value : empty;
+    }
+
+    void addTestData(const char* name, const char* phone, const char* address) {
+        auto dto = ContactDto::createShared();
+        dto->name = name;
+        dto->phone_number = phone;
+        dto->address = address;
+        save(dto, PhoneNumber::pack(dto->phone_number));
+    }
+};
@@ -0,0 +1,56 @@
+#pragma once
+
+/**
+ * Expected failures of the service and repository layers.
+ * They are returned instead of thrown; ErrorResponses maps each code to a pre-serialized response.
+ */
+enum class ErrorCode {
+  NONE = 0,
+  NOT_FOUND,
+  DELETE_NOT_FOUND,
+  PHONE_TAKEN,
+  NAME_REQUIRED,
+  NAME_TOO_LONG,
+  ADDRESS_REQUIRED,
+  PHONE_REQUIRED,
+  PHONE_INVALID,
+  INVALID_SORT,
+  INVALID_ORDER,
+  INVALID_OFFSET,
+  INVALID_LIMIT,
+  INVALID_AFTER,
+  TOO_MANY_REQUESTS,
+  BODY_REQUIRED,
+
+  COUNT
+};
+
+template<class T>
+class Result {
+private:
+  T m_value;
+  ErrorCode m_error;
+
+public:
+  Result(const T& value)
+    : m_value(value)
+    , m_error(ErrorCode::NONE)
+  {}
+
+  Result(ErrorCode error)
+    : m_value()
+    , m_error(error)
+  {}
+
+  bool ok() const {
+    return m_error == ErrorCode::NONE;
+  }
+
+  ErrorCode getError() const {
+    return m_error;
+  }
+
+  const T& getValue() const {
+    return m_value;
+  }
+};
@@ -2,27 +2,33 @@
 
 #include "dto/phonebook_dto.hpp"
 #include "repository/iphonebook_repository.hpp"
-#include "oatpp/web/protocol/http/Http.hpp"
-#include <regex> 
+#include "result.hpp"
+#include "timing/request_timing.hpp"
+#include "oatpp/encoding/Base64.hpp"
+#include "oatpp/core/utils/ConversionUtils.hpp"
+#include <string>
+
+/**
+ * One page of a listing.
+ * nextCursor is the opaque `after` value for the following page, null when the page is the last one.
+ */
+struct ContactPage {
+  oatpp::List<oatpp::Object<ContactDto>> contacts;
+  oatpp::String nextCursor;
+};
 
 class PhonebookService {
 private:
   std::shared_ptr<IPhonebookRepository> m_repository;
-  typedef oatpp::web::protocol::http::Status Status;
-  typedef oatpp::web::protocol::http::HttpError HttpError;
 
 public:
   PhonebookService(std::shared_ptr<IPhonebookRepository> repository)
       : m_repository(repository) {}
 
-  oatpp::Object<ContactDto> createContact(const oatpp::Object<ContactPayloadDto>& payload) {
-    payload->validate(); 
-    
-    if (m_repository->isPhoneNumberTaken(payload->phone_number)) {
-        throw oatpp::web::protocol::http::HttpError(
-            oatpp::web::protocol::http::Status::CODE_409, 
-            "Phone number already exists"
-        );
+  Result<oatpp::Object<ContactDto>> createContact(const oatpp::Object<ContactPayloadDto>& payload) {
+    Result<v_int64> phoneKey = validatePayload(payload);
+    if (!phoneKey.ok()) {
+        return phoneKey.getError();
     }
 
     auto newContact = ContactDto::createShared();
@@ -31,56 +37,184 @@ public:
     newContact->phone_number = payload->phone_number;
     newContact->address = payload->address;
 
-    return m_repository->save(newContact);
+    return m_repository->save(newContact, phoneKey.getValue());
   }
 
-  oatpp::Object<ContactDto> updateContact(v_int64 id, const oatpp::Object<ContactPayloadDto>& payload) {
+  Result<oatpp::Object<ContactDto>> updateContact(v_int64 id, const oatpp::Object<ContactPayloadDto>& payload) {
     auto existing = m_repository->get_by_id(id);
     if (!existing) {
-        throw HttpError(Status::CODE_404, "Contact not found");
+        return ErrorCode::NOT_FOUND;
     }
 
-    payload->validate(); 
-
-    if (m_repository->isPhoneNumberTaken(payload->phone_number, id)) {
-        throw oatpp::web::protocol::http::HttpError(
-            oatpp::web::protocol::http::Status::CODE_409, 
-            "Phone number already exists"
-        );
+    Result<v_int64> phoneKey = validatePayload(payload);
+    if (!phoneKey.ok()) {
+        return phoneKey.getError();
     }
 
     if (existing->name == payload->name && 
-        existing->phone_number == payload->phone_number && 
+        PhoneNumber::pack(existing->phone_number) == phoneKey.getValue() && 
         existing->address == payload->address) 
     {
         return existing; 
     }
 
-    existing->name = payload->name;
-    existing->phone_number = payload->phone_number;
-    existing->address = payload->address;
-    
-    return m_repository->save(existing);
-}
+    // Stored entry stays untouched until the repository accepts the new version.
+    auto updated = ContactDto::createShared();
+    updated->id = id;
+    updated->name = payload->name;
+    updated->phone_number = payload->phone_number;
+    updated->address = payload->address;
+
+    return m_repository->save(updated, phoneKey.getValue());
+  }
 
-  oatpp::Object<ContactDto> getContactById(v_int64 id) {
+  Result<oatpp::Object<ContactDto>> getContactById(v_int64 id) {
     auto contact = m_repository->get_by_id(id);
     if(!contact) {
-        throw HttpError(Status::CODE_404, "Contact not found");
+        return ErrorCode::NOT_FOUND;
+    }
+    return contact;
+  }
+
+  // phone is the decoded path value, '+' prefix included.
+  Result<oatpp::Object<ContactDto>> getContactByPhone(const oatpp::String& phone) {
+    v_int64 phoneKey = PhoneNumber::pack(phone);
+    if (phoneKey == PhoneNumber::INVALID) {
+        return ErrorCode::PHONE_INVALID;
+    }
+
+    auto contact = m_repository->get_by_phone(phoneKey);
+    if(!contact) {
+        return ErrorCode::NOT_FOUND;
     }
     return contact;
   }
 
-  oatpp::List<oatpp::Object<ContactDto>> getAllContacts() {
-    return m_repository->get_all();
+  Result<ContactPage> getAllContacts(const oatpp::String& sort, const oatpp::String& order,
+                                     const oatpp::String& after, const oatpp::String& offset,
+                                     const oatpp::String& limit) {
+    ContactSortField field = ContactSortField::ID;
+    if (sort && sort != "id") {
+        if (sort == "name") field = ContactSortField::NAME;
+        else if (sort == "phone") field = ContactSortField::PHONE;
+        else return ErrorCode::INVALID_SORT;
+    }
+
+    SortOrder sortOrder = SortOrder::ASC;
+    if (order && order != "asc") {
+        if (order == "desc") sortOrder = SortOrder::DESC;
+        else return ErrorCode::INVALID_ORDER;
+    }
+
+    ContactCursor cursor;
+    if (after && !decodeCursor(after, field, cursor)) {
+        return ErrorCode::INVALID_AFTER;
+    }
+    v_int64 offsetValue = 0;
+    if (!parsePageParam(offset, offsetValue)) {
+        return ErrorCode::INVALID_OFFSET;
+    }
+    v_int64 limitValue = -1;
+    if (!parsePageParam(limit, limitValue)) {
+        return ErrorCode::INVALID_LIMIT;
+    }
+
+    ContactPage page;
+    page.contacts = m_repository->get_sorted(field, sortOrder, after ? &cursor : nullptr, offsetValue, limitValue);
+    if (limitValue > 0 && (v_int64) page.contacts->size() == limitValue) {
+        page.nextCursor = encodeCursor(field, page.contacts->back());
+    }
+    return page;
+  }
+
+  ErrorCode deleteContact(v_int64 id) {
+    if(!m_repository->remove(id)) {
+        return ErrorCode::DELETE_NOT_FOUND;
+    }
+    return ErrorCode::NONE;
+  }
+
+private:
+  Result<v_int64> validatePayload(const oatpp::Object<ContactPayloadDto>& payload) {
+    StageTimer timer(RequestStage::VALIDATE);
+    return payload->validate();
+  }
+
+  // Leaves result untouched when the parameter is absent.
+  bool parsePageParam(const oatpp::String& value, v_int64& result) {
+    if (!value) {
+        return true;
+    }
+    if (value->empty()) {
+        return false;
+    }
+    bool success;
+    v_int64 parsed = oatpp::utils::conversion::strToInt64(value, success);
+    if (!success || parsed < 0) {
+        return false;
+    }
+    result = parsed;
+    return true;
+  }
+
+  // Cursor text is "<field>:<id>[:<sort key>]" (i - id, n - name, p - packed phone), URL-safe Base64 on the wire.
+  static char cursorTag(ContactSortField field) {
+    switch (field) {
+      case ContactSortField::NAME:  return 'n';
+      case ContactSortField::PHONE: return 'p';
+      default:                      return 'i';
+    }
+  }
+
+  static oatpp::String encodeCursor(ContactSortField field, const oatpp::Object<ContactDto>& last) {
+    std::string text(1, cursorTag(field));
+    text += ':';
+    text += std::to_string(*last->id);
+    if (field == ContactSortField::NAME) {
+        text += ':';
+        text += last->name ? *last->name : std::string();
+    } else if (field == ContactSortField::PHONE) {
+        text += ':';
+        text += std::to_string(PhoneNumber::pack(last->phone_number));
+    }
+    return oatpp::encoding::Base64::encode(text.data(), text.size(), oatpp::encoding::Base64::ALPHABET_BASE64_URL);
+  }
+
+  // A cursor is only valid for the sort field it was issued for.
+  static bool decodeCursor(const oatpp::String& value, ContactSortField field, ContactCursor& cursor) {
+    std::string text;
+    try {
+        text = *oatpp::encoding::Base64::decode(value, oatpp::encoding::Base64::ALPHABET_BASE64_URL_AUXILIARY_CHARS);
+    } catch (const oatpp::encoding::Base64::DecodingError&) {
+        return false;
+    }
+    if (text.size() < 3 || text[0] != cursorTag(field) || text[1] != ':') {
+        return false;
+    }
+
+    size_t idEnd = text.find(':', 2);
+    bool hasKey = field != ContactSortField::ID;
+    if (hasKey == (idEnd == std::string::npos)) {
+        return false;
+    }
+    if (!parseCursorNumber(text.substr(2, idEnd == std::string::npos ? std::string::npos : idEnd - 2), cursor.id)) {
+        return false;
+    }
+    if (field == ContactSortField::NAME) {
+        cursor.name = text.substr(idEnd + 1);
+    } else if (field == ContactSortField::PHONE) {
+        return parseCursorNumber(text.substr(idEnd + 1), cursor.phone);
+    }
+    return true;
   }
 
-  bool deleteContact(v_int64 id) {
-    bool result = m_repository->remove(id);
-    if(!result) {
-        throw HttpError(Status::CODE_404, "Cannot delete: Contact not found");
+  static bool parseCursorNumber(const std::string& text, v_int64& result) {
+    if (text.empty()) {
+        return false;
     }
-    return result;
+    bool success;
+    result = oatpp::utils::conversion::strToInt64(oatpp::String(text), success);
+    return success && result >= 0;
   }
   
-};
\ No newline at end of file
+};
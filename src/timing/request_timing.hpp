@@ -0,0 +1,253 @@
+#pragma once
+
+#include "oatpp/core/Types.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+  #include <x86intrin.h>
+  #define PHONEBOOK_TIMING_TSC 1
+#endif
+
+enum class RequestStage {
+  PARSE,
+  VALIDATE,
+  LOCK_WAIT,
+  REPOSITORY,
+  SERIALIZE,
+
+  COUNT
+};
+
+/**
+ * Cheap timestamp source: raw TSC on x86, steady_clock nanoseconds elsewhere.
+ * Ticks are converted to time only when a breakdown is reported.
+ */
+class TscClock {
+private:
+  static double calibrate() {
+#ifdef PHONEBOOK_TIMING_TSC
+    auto wallStart = std::chrono::steady_clock::now();
+    v_uint64 tscStart = __rdtsc();
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    v_uint64 tscEnd = __rdtsc();
+    auto wallEnd = std::chrono::steady_clock::now();
+    double micros = std::chrono::duration<double, std::micro>(wallEnd - wallStart).count();
+    return (tscEnd - tscStart) / micros;
+#else
+    return 1000.0;
+#endif
+  }
+
+public:
+  static v_uint64 now() {
+#ifdef PHONEBOOK_TIMING_TSC
+    return __rdtsc();
+#else
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+  }
+
+  /**
+   * Calibrated on first call (~20ms), call it at startup to keep that off the request path.
+   */
+  static double ticksPerMicrosecond() {
+    static const double value = calibrate();
+    return value;
+  }
+
+  static double toMillis(v_uint64 ticks) {
+    return ticks / ticksPerMicrosecond() / 1000.0;
+  }
+};
+
+/**
+ * Stage breakdown of the request currently served by this thread.
+ * HttpConnectionHandler serves a connection on one thread, so thread_local is per-request
+ * once begin() is called at the start of every request.
+ */
+class RequestTiming {
+private:
+  v_uint64 m_start = TscClock::now();
+  v_uint64 m_stages[(int) RequestStage::COUNT] = {};
+
+public:
+  static RequestTiming& current() {
+    thread_local RequestTiming timing;
+    return timing;
+  }
+
+  static const char* getStageName(RequestStage stage) {
+    switch (stage) {
+      case RequestStage::PARSE:      return "parse";
+      case RequestStage::VALIDATE:   return "validate";
+      case RequestStage::LOCK_WAIT:  return "lock";
+      case RequestStage::REPOSITORY: return "repo";
+      case RequestStage::SERIALIZE:  return "serialize";
+      default:                       return "unknown";
+    }
+  }
+
+  void begin() {
+    m_start = TscClock::now();
+    std::fill(std::begin(m_stages), std::end(m_stages), 0);
+  }
+
+  void add(RequestStage stage, v_uint64 ticks) {
+    m_stages[(int) stage] += ticks;
+  }
+
+  v_uint64 getStageTicks(RequestStage stage) const {
+    return m_stages[(int) stage];
+  }
+
+  v_uint64 getTotalTicks() const {
+    return TscClock::now() - m_start;
+  }
+
+  /**
+   * Value for the Server-Timing response header, durations in milliseconds.
+   */
+  std::string toServerTiming() const {
+    std::string result;
+    char buffer[64];
+    for (int i = 0; i < (int) RequestStage::COUNT; i++) {
+      std::snprintf(buffer, sizeof(buffer), "%s;dur=%.3f, ", getStageName((RequestStage) i), TscClock::toMillis(m_stages[i]));
+      result += buffer;
+    }
+    std::snprintf(buffer, sizeof(buffer), "total;dur=%.3f", TscClock::toMillis(getTotalTicks()));
+    result += buffer;
+    return result;
+  }
+};
+
+/**
+ * Adds the time spent in its scope to the given stage of the current request.
+ */
+class StageTimer {
+private:
+  RequestStage m_stage;
+  v_uint64 m_start;
+
+public:
+  explicit StageTimer(RequestStage stage)
+    : m_stage(stage)
+    , m_start(TscClock::now())
+  {}
+
+  StageTimer(const StageTimer&) = delete;
+  StageTimer& operator=(const StageTimer&) = delete;
+
+  ~StageTimer() {
+    RequestTiming::current().add(m_stage, TscClock::now() - m_start);
+  }
+};
+
+/**
+ * Ring of the most recent requests slower than a threshold, with their stage breakdowns.
+ * Writers claim a slot with fetch_add and publish it under a per-slot sequence counter (seqlock),
+ * readers copy slots optimistically and drop the ones that changed underneath. No locks on either side.
+ */
+class SlowRequestLog {
+public:
+  static constexpr v_uint32 CAPACITY = 64;
+  static constexpr v_uint32 LABEL_WORDS = 8;
+  static constexpr v_uint64 DEFAULT_THRESHOLD_MICROS = 20000;
+
+  struct Record {
+    std::string label;
+    double totalMs;
+    double stageMs[(int) RequestStage::COUNT];
+  };
+
+private:
+  struct Slot {
+    std::atomic<v_uint64> sequence{0};
+    std::atomic<v_uint64> label[LABEL_WORDS];
+    std::atomic<v_uint64> totalTicks;
+    std::atomic<v_uint64> stageTicks[(int) RequestStage::COUNT];
+  };
+
+  Slot m_slots[CAPACITY];
+  std::atomic<v_uint64> m_next{0};
+  v_uint64 m_thresholdTicks;
+
+public:
+  explicit SlowRequestLog(v_uint64 thresholdMicros = DEFAULT_THRESHOLD_MICROS)
+    : m_thresholdTicks((v_uint64) (thresholdMicros * TscClock::ticksPerMicrosecond()))
+  {}
+
+  bool isSlow(const RequestTiming& timing) const {
+    return timing.getTotalTicks() >= m_thresholdTicks;
+  }
+
+  void record(const std::string& label, const RequestTiming& timing) {
+    v_uint64 total = timing.getTotalTicks();
+    if (total < m_thresholdTicks) {
+      return;
+    }
+
+    Slot& slot = m_slots[m_next.fetch_add(1, std::memory_order_relaxed) % CAPACITY];
+    v_uint64 sequence = slot.sequence.load(std::memory_order_relaxed);
+    // Odd sequence - another writer lapped the ring and is still writing this slot, drop the record.
+    if ((sequence & 1) || !slot.sequence.compare_exchange_strong(sequence, sequence + 1, std::memory_order_relaxed)) {
+      return;
+    }
+    std::atomic_thread_fence(std::memory_order_release);
+
+    v_uint64 words[LABEL_WORDS] = {};
+    std::memcpy(words, label.data(), std::min<size_t>(label.size(), sizeof(words) - 1));
+    for (v_uint32 i = 0; i < LABEL_WORDS; i++) {
+      slot.label[i].store(words[i], std::memory_order_relaxed);
+    }
+    slot.totalTicks.store(total, std::memory_order_relaxed);
+    for (int i = 0; i < (int) RequestStage::COUNT; i++) {
+      slot.stageTicks[i].store(timing.getStageTicks((RequestStage) i), std::memory_order_relaxed);
+    }
+
+    slot.sequence.store(sequence + 2, std::memory_order_release);
+  }
+
+  /**
+   * @return - captured requests, slowest first.
+   */
+  std::vector<Record> getRecords() const {
+    std::vector<Record> records;
+    for (const Slot& slot : m_slots) {
+      v_uint64 before = slot.sequence.load(std::memory_order_acquire);
+      if (before == 0 || (before & 1)) {
+        continue;
+      }
+
+      v_uint64 words[LABEL_WORDS];
+      for (v_uint32 i = 0; i < LABEL_WORDS; i++) {
+        words[i] = slot.label[i].load(std::memory_order_relaxed);
+      }
+      Record record;
+      record.totalMs = TscClock::toMillis(slot.totalTicks.load(std::memory_order_relaxed));
+      for (int i = 0; i < (int) RequestStage::COUNT; i++) {
+        record.stageMs[i] = TscClock::toMillis(slot.stageTicks[i].load(std::memory_order_relaxed));
+      }
+
+      std::atomic_thread_fence(std::memory_order_acquire);
+      if (slot.sequence.load(std::memory_order_relaxed) != before) {
+        continue;
+      }
+
+      record.label.assign(reinterpret_cast<const char*>(words), strnlen(reinterpret_cast<const char*>(words), sizeof(words)));
+      records.push_back(std::move(record));
+    }
+
+    std::sort(records.begin(), records.end(), [](const Record& a, const Record& b) {
+      return a.totalMs > b.totalMs;
+    });
+    return records;
+  }
+};
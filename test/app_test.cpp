@@ -2,6 +2,8 @@
 #include <thread>
 #include <vector>
 #include <chrono>
+#include <atomic>
+#include <regex>
 
 #include "oatpp/core/base/Environment.hpp"
 #include "oatpp/web/client/HttpRequestExecutor.hpp"
@@ -13,8 +15,15 @@
 
 #include "phonebook_test_client.hpp"
 #include "controller/phonebook_controller.hpp"
+#include "controller/debug_controller.hpp"
 #include "dto/phonebook_dto.hpp"
 #include "app_component.hpp" 
+#include "interceptor/rate_limiter.hpp"
+#include "timing/request_timing.hpp"
+#include "repository/persistent_map.hpp"
+#include "repository/persistent_ordered_set.hpp"
+#include "repository/phonebook_repository.hpp"
+#include "repository/snapshot_phonebook_repository.hpp"
 
 class PhonebookTest : public ::testing::Test {
 protected:
@@ -173,6 +182,129 @@ TEST_F(PhonebookTest, DeleteIdempotency) {
     ASSERT_EQ(client->delete_contact(created->id)->getStatusCode(), 404);
 }
 
+TEST_F(PhonebookTest, SortedListingAndPagination) {
+    const char* names[] = {"Zoe", "Adam", "Mila"};
+    const char* phones[] = {"+375331110001", "+375171110002", "+375441110003"};
+    for(int i = 0; i < 3; i++) {
+        auto payload = ContactPayloadDto::createShared();
+        payload->name = names[i];
+        payload->phone_number = phones[i];
+        payload->address = "Sort St";
+        ASSERT_EQ(client->create_contact(payload)->getStatusCode(), 200);
+    }
+
+    auto resAsc = client->get_sorted_contacts("name", "asc", "0", "1000");
+    ASSERT_EQ(resAsc->getStatusCode(), 200);
+    auto byNameAsc = resAsc->template readBodyToDto<oatpp::List<oatpp::Object<ContactDto>>>(mapper);
+    ASSERT_GE(byNameAsc->size(), 6);
+    for(auto prev = byNameAsc->begin(), it = std::next(prev); it != byNameAsc->end(); prev = it++) {
+        ASSERT_LE(*(*prev)->name, *(*it)->name);
+    }
+
+    auto byPhoneDesc = client->get_sorted_contacts("phone", "desc", "0", "1000")
+        ->template readBodyToDto<oatpp::List<oatpp::Object<ContactDto>>>(mapper);
+    ASSERT_EQ(byPhoneDesc->size(), byNameAsc->size());
+    for(auto prev = byPhoneDesc->begin(), it = std::next(prev); it != byPhoneDesc->end(); prev = it++) {
+        ASSERT_GE(*(*prev)->phone_number, *(*it)->phone_number);
+    }
+
+    auto page = client->get_sorted_contacts("name", "asc", "1", "2")
+        ->template readBodyToDto<oatpp::List<oatpp::Object<ContactDto>>>(mapper);
+    ASSERT_EQ(page->size(), 2);
+    auto expected = std::next(byNameAsc->begin());
+    for(auto& contact : *page) {
+        ASSERT_EQ(contact->id, (*expected++)->id);
+    }
+
+    // Keyset pagination: a full page carries the cursor of the next one.
+    auto resFirst = client->get_sorted_contacts("name", "asc", "0", "2");
+    auto firstPage = resFirst->template readBodyToDto<oatpp::List<oatpp::Object<ContactDto>>>(mapper);
+    ASSERT_EQ(firstPage->size(), 2);
+    auto cursor = resFirst->getHeader("X-Next-Cursor");
+    ASSERT_TRUE(cursor);
+    auto resNext = client->get_contacts_after("name", "asc", cursor, "2");
+    ASSERT_EQ(resNext->getStatusCode(), 200);
+    auto nextPage = resNext->template readBodyToDto<oatpp::List<oatpp::Object<ContactDto>>>(mapper);
+    ASSERT_EQ(nextPage->size(), 2);
+    expected = std::next(byNameAsc->begin(), 2);
+    for(auto& contact : *nextPage) {
+        ASSERT_EQ(contact->id, (*expected++)->id);
+    }
+
+    // The cursor holds the sort key, so it stays valid when its contact is gone.
+    ASSERT_EQ(client->delete_contact(firstPage->back()->id)->getStatusCode(), 200);
+    auto afterDelete = client->get_contacts_after("name", "asc", cursor, "2")
+        ->template readBodyToDto<oatpp::List<oatpp::Object<ContactDto>>>(mapper);
+    ASSERT_EQ(afterDelete->size(), 2);
+    ASSERT_EQ(afterDelete->front()->id, nextPage->front()->id);
+
+    auto lastPage = client->get_contacts_after("name", "asc", cursor, "1000");
+    ASSERT_EQ(lastPage->getStatusCode(), 200);
+    ASSERT_FALSE(lastPage->getHeader("X-Next-Cursor"));
+
+    ASSERT_EQ(client->get_contacts_after("phone", "asc", cursor, "2")->getStatusCode(), 400);
+    ASSERT_EQ(client->get_contacts_after("name", "asc", "12", "2")->getStatusCode(), 400);
+    ASSERT_EQ(client->get_contacts_after("name", "asc", "not a cursor", "2")->getStatusCode(), 400);
+    ASSERT_EQ(client->get_sorted_contacts("id", "asc", "0", "")->getStatusCode(), 400);
+
+    ASSERT_EQ(client->get_sorted_contacts("address", "asc", "0", "10")->getStatusCode(), 400);
+    ASSERT_EQ(client->get_sorted_contacts("name", "up", "0", "10")->getStatusCode(), 400);
+    ASSERT_EQ(client->get_sorted_contacts("id", "asc", "-1", "10")->getStatusCode(), 400);
+}
+
+TEST_F(PhonebookTest, LookupByPhone) {
+    auto payload = ContactPayloadDto::createShared();
+    payload->name = "Phone Lookup";
+    payload->phone_number = "+375445556677";
+    payload->address = "Brest";
+    auto created = client->create_contact(payload)->template readBodyToDto<oatpp::Object<ContactDto>>(mapper);
+
+    auto res = client->get_contact_by_phone("+375445556677");
+    ASSERT_EQ(res->getStatusCode(), 200);
+    ASSERT_EQ(res->template readBodyToDto<oatpp::Object<ContactDto>>(mapper)->id, created->id);
+    ASSERT_EQ(client->get_contact_by_phone("375445556677")->getStatusCode(), 200);
+
+    payload->phone_number = "+375445556688";
+    ASSERT_EQ(client->update_contact(created->id, payload)->getStatusCode(), 200);
+    ASSERT_EQ(client->get_contact_by_phone("+375445556677")->getStatusCode(), 404);
+    ASSERT_EQ(client->get_contact_by_phone("+375445556688")->getStatusCode(), 200);
+
+    ASSERT_EQ(client->get_contact_by_phone("+375991234567")->getStatusCode(), 400);
+}
+
+TEST_F(PhonebookTest, ErrorResponsesCarryStatusBody) {
+    auto resMissing = client->get_contact_by_id(99999);
+    ASSERT_EQ(resMissing->getStatusCode(), 404);
+    auto missing = resMissing->template readBodyToDto<oatpp::Object<StatusDto>>(mapper);
+    ASSERT_EQ(missing->status, "ERROR");
+    ASSERT_EQ(missing->code, 404);
+    ASSERT_EQ(missing->message, "Contact not found");
+
+    auto first = ContactPayloadDto::createShared();
+    first->name = "Conflict A";
+    first->phone_number = "+375337001001";
+    first->address = "Minsk";
+    auto second = ContactPayloadDto::createShared();
+    second->name = "Conflict B";
+    second->phone_number = "+375337001002";
+    second->address = "Minsk";
+    ASSERT_EQ(client->create_contact(first)->getStatusCode(), 200);
+    auto created = client->create_contact(second)->template readBodyToDto<oatpp::Object<ContactDto>>(mapper);
+
+    auto resConflict = client->create_contact(first);
+    ASSERT_EQ(resConflict->getStatusCode(), 409);
+    auto conflict = resConflict->template readBodyToDto<oatpp::Object<StatusDto>>(mapper);
+    ASSERT_EQ(conflict->code, 409);
+    ASSERT_EQ(conflict->message, "Phone number already exists");
+
+    second->name = "Conflict B Renamed";
+    second->phone_number = first->phone_number;
+    ASSERT_EQ(client->update_contact(created->id, second)->getStatusCode(), 409);
+    auto unchanged = client->get_contact_by_id(created->id)->template readBodyToDto<oatpp::Object<ContactDto>>(mapper);
+    ASSERT_EQ(unchanged->name, "Conflict B");
+    ASSERT_EQ(unchanged->phone_number, "+375337001002");
+}
+
 TEST_F(PhonebookTest, ConcurrentCreation) {
     const int numThreads = 10;
     std::vector<std::thread> threads;
@@ -195,6 +327,405 @@ TEST_F(PhonebookTest, ConcurrentCreation) {
     ASSERT_GE(list->size(), 13);
 }
 
+/**
+ * Serves the controllers through the production connection handler (error handler and interceptors included).
+ */
+class ProductionHandlerTest : public ::testing::Test {
+protected:
+    virtual AppConfig createConfig() {
+        return AppConfig();
+    }
+
+    void SetUp() override {
+        AppConfig config = createConfig();
+        components = std::make_unique<AppComponent>(config);
+        mapper = components->apiObjectMapper.getObject();
+
+        auto router = components->httpRouter.getObject();
+        router->addController(std::make_shared<PhonebookController>(mapper));
+        if (config.debugEndpoints) {
+            router->addController(std::make_shared<DebugController>(mapper));
+        }
+
+        auto serverProv = oatpp::network::tcp::server::ConnectionProvider::createShared({"127.0.0.1", 8003});
+        server = std::make_unique<oatpp::network::Server>(serverProv, components->serverConnectionHandler.getObject());
+
+        serverThread = std::thread([this] {
+            server->run();
+        });
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(500));
+
+        auto clientProv = oatpp::network::tcp::client::ConnectionProvider::createShared({"127.0.0.1", 8003});
+        auto requestExecutor = oatpp::web::client::HttpRequestExecutor::createShared(clientProv);
+
+        client = PhonebookTestClient::createShared(requestExecutor, mapper);
+    }
+
+    void TearDown() override {
+        if(server) server->stop();
+        if (serverThread.joinable()) serverThread.join();
+        components.reset();
+    }
+
+    std::unique_ptr<AppComponent> components;
+    std::shared_ptr<PhonebookTestClient> client;
+    std::shared_ptr<oatpp::data::mapping::ObjectMapper> mapper;
+    std::unique_ptr<oatpp::network::Server> server;
+    std::thread serverThread;
+};
+
+class RateLimitTest : public ProductionHandlerTest {
+protected:
+    AppConfig createConfig() override {
+        AppConfig config;
+        config.rateLimits = {{"POST", "/contacts", 1, 3}};
+        config.apiKeys = {"trusted-key"};
+        return config;
+    }
+
+    oatpp::Object<ContactPayloadDto> payload(int i) {
+        auto p = ContactPayloadDto::createShared();
+        p->name = "Limited " + std::to_string(i);
+        p->phone_number = "+37544" + std::to_string(2000000 + i);
+        p->address = "Minsk";
+        return p;
+    }
+};
+
+TEST_F(RateLimitTest, BurstExceededReturns429) {
+    for(int i = 0; i < 3; i++) {
+        ASSERT_EQ(client->create_contact(payload(i))->getStatusCode(), 200);
+    }
+
+    auto resLimited = client->create_contact(payload(3));
+    ASSERT_EQ(resLimited->getStatusCode(), 429);
+    ASSERT_EQ(resLimited->getHeader("Retry-After"), "1");
+    auto status = resLimited->template readBodyToDto<oatpp::Object<StatusDto>>(mapper);
+    ASSERT_EQ(status->status, "ERROR");
+    ASSERT_EQ(status->code, 429);
+    ASSERT_EQ(status->message, "Too many requests");
+
+    ASSERT_EQ(client->create_contact_with_query("test", payload(4))->getStatusCode(), 429);
+    ASSERT_EQ(client->get_all_contacts()->getStatusCode(), 200);
+
+    // Only configured keys get their own bucket, anything else is limited by peer address.
+    ASSERT_EQ(client->create_contact_with_key("rotated-key", payload(5))->getStatusCode(), 429);
+    ASSERT_EQ(client->create_contact_with_key("trusted-key", payload(6))->getStatusCode(), 200);
+
+    // Debug endpoints are off unless enabled in the config.
+    ASSERT_EQ(client->get_slow_requests()->getStatusCode(), 404);
+}
+
+class SnapshotRepositoryHandlerTest : public ProductionHandlerTest {
+protected:
+    AppConfig createConfig() override {
+        AppConfig config;
+        config.snapshotRepository = true;
+        return config;
+    }
+};
+
+TEST_F(SnapshotRepositoryHandlerTest, CrudAndPagination) {
+    auto payload = ContactPayloadDto::createShared();
+    payload->name = "Snapshot";
+    payload->phone_number = "+375295550011";
+    payload->address = "Minsk";
+    auto resCreate = client->create_contact(payload);
+    ASSERT_EQ(resCreate->getStatusCode(), 200);
+    auto created = resCreate->template readBodyToDto<oatpp::Object<ContactDto>>(mapper);
+    ASSERT_EQ(client->create_contact(payload)->getStatusCode(), 409);
+
+    auto resPhone = client->get_contact_by_phone("%2B375295550011");
+    ASSERT_EQ(resPhone->getStatusCode(), 200);
+    ASSERT_EQ(resPhone->template readBodyToDto<oatpp::Object<ContactDto>>(mapper)->id, created->id);
+
+    payload->phone_number = "+375295550022";
+    ASSERT_EQ(client->update_contact(created->id, payload)->getStatusCode(), 200);
+    ASSERT_EQ(client->get_contact_by_phone("+375295550011")->getStatusCode(), 404);
+    ASSERT_EQ(client->get_contact_by_phone("375295550022")->getStatusCode(), 200);
+
+    auto byPhone = client->get_sorted_contacts("phone", "desc", "0", "1000")
+        ->template readBodyToDto<oatpp::List<oatpp::Object<ContactDto>>>(mapper);
+    ASSERT_EQ(byPhone->size(), 4);
+    auto resFirst = client->get_sorted_contacts("phone", "desc", "0", "2");
+    auto cursor = resFirst->getHeader("X-Next-Cursor");
+    ASSERT_TRUE(cursor);
+    ASSERT_EQ(client->delete_contact(resFirst->template readBodyToDto<oatpp::List<oatpp::Object<ContactDto>>>(mapper)->back()->id)->getStatusCode(), 200);
+    auto nextPage = client->get_contacts_after("phone", "desc", cursor, "2")
+        ->template readBodyToDto<oatpp::List<oatpp::Object<ContactDto>>>(mapper);
+    ASSERT_EQ(nextPage->size(), 2);
+    auto expected = std::next(byPhone->begin(), 2);
+    for(auto& contact : *nextPage) {
+        ASSERT_EQ(contact->id, (*expected++)->id);
+    }
+}
+
+class RequestTimingIntegrationTest : public ProductionHandlerTest {
+protected:
+    AppConfig createConfig() override {
+        AppConfig config;
+        config.serverTiming = true;
+        config.debugEndpoints = true;
+        config.slowRequestThresholdMicros = 0;
+        return config;
+    }
+};
+
+TEST_F(RequestTimingIntegrationTest, ServerTimingAndSlowRequestLog) {
+    auto payload = ContactPayloadDto::createShared();
+    payload->name = "Timed";
+    payload->phone_number = "+375297776655";
+    payload->address = "Minsk";
+
+    auto resCreate = client->create_contact(payload);
+    ASSERT_EQ(resCreate->getStatusCode(), 200);
+    ASSERT_EQ(client->get_contact_by_phone("+375297776655")->getStatusCode(), 200);
+    auto serverTiming = resCreate->getHeader("Server-Timing");
+    ASSERT_TRUE(serverTiming);
+    std::regex format(R"(parse;dur=\d+\.\d{3}, validate;dur=\d+\.\d{3}, lock;dur=\d+\.\d{3}, )"
+                      R"(repo;dur=\d+\.\d{3}, serialize;dur=\d+\.\d{3}, total;dur=\d+\.\d{3})");
+    ASSERT_TRUE(std::regex_match(*serverTiming, format)) << *serverTiming;
+
+    auto resSlow = client->get_slow_requests();
+    ASSERT_EQ(resSlow->getStatusCode(), 200);
+    auto records = resSlow->template readBodyToDto<oatpp::List<oatpp::Object<SlowRequestDto>>>(mapper);
+    oatpp::Object<SlowRequestDto> created;
+    bool lookupRecorded = false;
+    for(auto& record : *records) {
+        if(record->request == "POST /contacts") created = record;
+        if(record->request == "GET /contacts/by-phone/{phone}") lookupRecorded = true;
+        // labels are route patterns, path and query values never end up in the log
+        ASSERT_EQ(record->request->find("7776655"), std::string::npos) << *record->request;
+    }
+    ASSERT_TRUE(created);
+    ASSERT_TRUE(lookupRecorded);
+    ASSERT_EQ(created->stages_ms->size(), (size_t) RequestStage::COUNT);
+
+    v_float64 stagesMs = 0;
+    for(auto& stage : *created->stages_ms) stagesMs += (v_float64) stage.second;
+    ASSERT_GT((v_float64) created->total_ms, 0);
+    ASSERT_GE((v_float64) created->total_ms + 0.001, stagesMs);
+}
+
+TEST(RateLimiterTest, TokenBucketRefillAndBurst) {
+    TokenBucketTable buckets(16, 10, 5);
+
+    int allowed = 0;
+    for(int i = 0; i < 10; i++) allowed += buckets.tryAcquire(42, 1);
+    ASSERT_EQ(allowed, 5);
+
+    ASSERT_FALSE(buckets.tryAcquire(42, 50));
+    ASSERT_TRUE(buckets.tryAcquire(42, 101));
+    ASSERT_TRUE(buckets.tryAcquire(7, 101));
+
+    allowed = 0;
+    for(int i = 0; i < 10; i++) allowed += buckets.tryAcquire(42, 100000);
+    ASSERT_EQ(allowed, 5);
+}
+
+TEST(RateLimiterTest, ConcurrentAcquireNeverExceedsBurst) {
+    TokenBucketTable buckets(1024, 0, 1000);
+    std::atomic<int> allowed{0};
+    std::vector<std::thread> threads;
+    for(int i = 0; i < 8; i++) {
+        threads.push_back(std::thread([&buckets, &allowed] {
+            for(int j = 0; j < 1000; j++) allowed += buckets.tryAcquire(1, 5);
+        }));
+    }
+    for(auto& t : threads) t.join();
+    ASSERT_EQ(allowed, 1000);
+}
+
+TEST(RateLimiterTest, NewClientsEvictFullestBucket) {
+    TokenBucketTable buckets(16, 1, 5);
+    for(int i = 0; i < 5; i++) ASSERT_TRUE(buckets.tryAcquire(42, 1));
+    ASSERT_FALSE(buckets.tryAcquire(42, 1));
+
+    // Every newcomer gets a bucket of its own, taking over the ones with tokens left, not the drained one.
+    for(v_uint64 client = 1000; client < 2000; client++) {
+        ASSERT_TRUE(buckets.tryAcquire(client, 2));
+    }
+    ASSERT_FALSE(buckets.tryAcquire(42, 3));
+
+    int allowed = 0;
+    for(int i = 0; i < 10; i++) allowed += buckets.tryAcquire(5000, 3);
+    ASSERT_EQ(allowed, 5);
+}
+
+TEST(RateLimiterTest, IdleSlotsAreReclaimed) {
+    TokenBucketTable buckets(16, 10, 5);
+    for(v_uint64 client = 1; client <= 1000; client++) buckets.tryAcquire(client, 1);
+
+    // 1 token refills in 100ms, so every bucket above is full again after 101ms.
+    for(v_uint64 client = 2001; client <= 2016; client++) {
+        int allowed = 0;
+        for(int i = 0; i < 10; i++) allowed += buckets.tryAcquire(client, 200);
+        ASSERT_EQ(allowed, 5);
+    }
+}
+
+TEST(RateLimiterTest, RuleMatching) {
+    RateLimitRule exact{"POST", "/contacts", 1, 1};
+    ASSERT_TRUE(exact.matches("POST", "/contacts"));
+    ASSERT_FALSE(exact.matches("POST", "/contacts/1"));
+    ASSERT_FALSE(exact.matches("GET", "/contacts"));
+
+    RateLimitRule prefix{"PUT", "/contacts/*", 1, 1};
+    ASSERT_TRUE(prefix.matches("PUT", "/contacts/5"));
+    ASSERT_FALSE(prefix.matches("PUT", "/contacts"));
+}
+
+TEST(AppConfigTest, ParseRateLimits) {
+    std::vector<RateLimitRule> rules;
+    ASSERT_TRUE(AppConfig::parseRateLimits("POST /contacts 20 40; DELETE /contacts/* 5 10;", rules));
+    ASSERT_EQ(rules.size(), 2);
+    ASSERT_EQ(rules[1].method, "DELETE");
+    ASSERT_EQ(rules[1].path, "/contacts/*");
+    ASSERT_EQ(rules[1].ratePerSecond, 5);
+    ASSERT_EQ(rules[1].burst, 10);
+
+    std::vector<RateLimitRule> malformed;
+    ASSERT_FALSE(AppConfig::parseRateLimits("POST /contacts 20", malformed));
+    ASSERT_FALSE(AppConfig::parseRateLimits("POST /contacts 20 0", malformed));
+    ASSERT_FALSE(AppConfig::parseRateLimits("POST /contacts 20 40 60", malformed));
+
+    std::vector<RateLimitRule> none;
+    ASSERT_TRUE(AppConfig::parseRateLimits("", none));
+    ASSERT_TRUE(none.empty());
+}
+
+TEST(RequestTimingTest, SlowRequestLogKeepsSlowestFirst) {
+    SlowRequestLog log(0);
+    auto& timing = RequestTiming::current();
+
+    timing.begin();
+    {
+        StageTimer timer(RequestStage::VALIDATE);
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    }
+    log.record("POST /contacts", timing);
+
+    timing.begin();
+    {
+        StageTimer timer(RequestStage::REPOSITORY);
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    log.record("GET /contacts", timing);
+
+    auto records = log.getRecords();
+    ASSERT_EQ(records.size(), 2);
+    ASSERT_EQ(records[0].label, "GET /contacts");
+    ASSERT_GE(records[0].stageMs[(int) RequestStage::REPOSITORY], 9.0);
+    ASSERT_GE(records[0].totalMs, records[0].stageMs[(int) RequestStage::REPOSITORY]);
+    ASSERT_EQ(records[1].label, "POST /contacts");
+    ASSERT_GE(records[1].stageMs[(int) RequestStage::VALIDATE], 1.0);
+
+    ASSERT_NE(timing.toServerTiming().find("repo;dur="), std::string::npos);
+}
+
+TEST(RequestTimingTest, FastRequestsAreNotCaptured) {
+    SlowRequestLog log(1000000);
+    RequestTiming::current().begin();
+    log.record("GET /contacts", RequestTiming::current());
+    ASSERT_TRUE(log.getRecords().empty());
+}
+
+TEST(PersistentMapTest, OldVersionsStayIntact) {
+    PersistentMap<int> base;
+    for(int i = 1; i <= 100; i++) base = base.set(i, i * 10);
+    auto next = base.erase(50).set(1000000, 7).set(1, 11);
+
+    ASSERT_EQ(base.size(), 100);
+    ASSERT_EQ(*base.find(50), 500);
+    ASSERT_EQ(*base.find(1), 10);
+    ASSERT_EQ(base.find(1000000), nullptr);
+
+    ASSERT_EQ(next.size(), 100);
+    ASSERT_EQ(next.find(50), nullptr);
+    ASSERT_EQ(*next.find(1), 11);
+    ASSERT_EQ(*next.find(1000000), 7);
+
+    std::vector<v_uint64> keys;
+    next.forEach(true, 1, [&keys](v_uint64 key, int) {
+        keys.push_back(key);
+        return keys.size() < 3;
+    });
+    ASSERT_EQ(keys, (std::vector<v_uint64>{100, 99, 98}));
+}
+
+TEST(PersistentOrderedSetTest, OldVersionsStayIntact) {
+    PersistentOrderedSet<v_int64> base;
+    for(v_int64 i = 1; i <= 100; i++) base = base.insert(i * 2);
+    auto next = base.erase(50).insert(51).insert(2);
+
+    ASSERT_EQ(base.size(), 100);
+    ASSERT_TRUE(base.contains(50));
+    ASSERT_FALSE(base.contains(51));
+    ASSERT_EQ(base.rank(51), 25);
+
+    ASSERT_EQ(next.size(), 100);
+    ASSERT_FALSE(next.contains(50));
+    ASSERT_TRUE(next.contains(51));
+    ASSERT_EQ(next.rank(52), 25);
+
+    std::vector<v_int64> keys;
+    next.forEach(false, 23, [&keys](v_int64 key) {
+        keys.push_back(key);
+        return keys.size() < 3;
+    });
+    ASSERT_EQ(keys, (std::vector<v_int64>{48, 51, 52}));
+}
+
+TEST(SnapshotRepositoryTest, MatchesLockingRepository) {
+    PhonebookRepository locking;
+    SnapshotPhonebookRepository snapshot;
+    std::vector<IPhonebookRepository*> repositories = {&locking, &snapshot};
+
+    for(auto repository : repositories) {
+        for(int i = 0; i < 20; i++) {
+            auto contact = ContactDto::createShared();
+            contact->name = "User " + std::to_string(i % 7);
+            contact->phone_number = "+37533" + std::to_string(1000000 + (i * 37) % 100);
+            contact->address = "Addr";
+            repository->save(contact, PhoneNumber::pack(contact->phone_number));
+        }
+        auto moved = ContactDto::createShared();
+        moved->id = (v_int64) 5;
+        moved->name = "Moved";
+        moved->phone_number = "+375251234567";
+        moved->address = "Addr";
+        ASSERT_EQ(repository->save(moved, PhoneNumber::pack(moved->phone_number)).getError(), ErrorCode::PHONE_TAKEN);
+        moved->phone_number = "+375259999999";
+        ASSERT_TRUE(repository->save(moved, PhoneNumber::pack(moved->phone_number)).ok());
+        ASSERT_TRUE(repository->remove(7));
+        ASSERT_FALSE(repository->remove(7));
+    }
+
+    // Cursors of existing contacts and of the removed contact 7 (i = 3 above, ids 1-3 are the seed data).
+    std::vector<ContactCursor> cursors;
+    for(v_int64 id : {4, 12}) {
+        auto contact = locking.get_by_id(id);
+        cursors.push_back({id, *contact->name, PhoneNumber::pack(contact->phone_number)});
+    }
+    cursors.push_back({7, "User 3", PhoneNumber::pack(oatpp::String("+375331000011"))});
+
+    for(auto field : {ContactSortField::ID, ContactSortField::NAME, ContactSortField::PHONE}) {
+        for(auto order : {SortOrder::ASC, SortOrder::DESC}) {
+            for(size_t i = 0; i <= cursors.size(); i++) {
+                const ContactCursor* after = i < cursors.size() ? &cursors[i] : nullptr;
+                auto expected = locking.get_sorted(field, order, after, 2, 10);
+                auto actual = snapshot.get_sorted(field, order, after, 2, 10);
+                ASSERT_EQ(actual->size(), expected->size());
+                for(auto e = expected->begin(), a = actual->begin(); e != expected->end(); ++e, ++a) {
+                    ASSERT_EQ((*a)->id, (*e)->id);
+                }
+            }
+        }
+    }
+    ASSERT_EQ(snapshot.get_by_phone(375259999999)->name, "Moved");
+}
+
 int main(int argc, char **argv) {
     oatpp::base::Environment::init();
     ::testing::InitGoogleTest(&argc, argv);
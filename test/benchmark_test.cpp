@@ -18,6 +18,9 @@
 #include "controller/phonebook_controller.hpp"
 #include "dto/phonebook_dto.hpp"
 #include "app_component.hpp" 
+#include "repository/phonebook_repository.hpp"
+#include "repository/snapshot_phonebook_repository.hpp"
+#include <algorithm>
 
 class BenchmarkTest : public ::testing::Test {
 protected:
@@ -125,6 +128,77 @@ TEST_F(BenchmarkTest, FullCrudThroughput) {
     ASSERT_EQ(failCount, 0);
 }
 
+template<class Repository>
+std::vector<double> measureWritesDuringScans(int contacts, int writes, int readers) {
+    Repository repository;
+    for(int i = 0; i < contacts; i++) {
+        auto contact = ContactDto::createShared();
+        contact->name = "Seed " + std::to_string(i);
+        contact->phone_number = "+37529" + std::to_string(2000000 + i);
+        contact->address = "Seed St";
+        repository.save(contact, PhoneNumber::pack(contact->phone_number));
+    }
+
+    std::atomic<bool> stop{false};
+    std::atomic<long> scans{0};
+    std::vector<std::thread> readerThreads;
+    for(int i = 0; i < readers; i++) {
+        readerThreads.push_back(std::thread([&repository, &stop, &scans] {
+            while(!stop) {
+                repository.get_all();
+                scans++;
+            }
+        }));
+    }
+
+    std::vector<double> latenciesUs;
+    for(int i = 0; i < writes; i++) {
+        auto contact = ContactDto::createShared();
+        contact->name = "Writer " + std::to_string(i);
+        contact->phone_number = "+37544" + std::to_string(1000000 + i);
+        contact->address = "Writer St";
+
+        auto start = std::chrono::steady_clock::now();
+        repository.save(contact, PhoneNumber::pack(contact->phone_number));
+        auto end = std::chrono::steady_clock::now();
+        latenciesUs.push_back(std::chrono::duration<double, std::micro>(end - start).count());
+        // spread writes over the scans instead of squeezing them in between two of them
+        std::this_thread::sleep_for(std::chrono::microseconds(200));
+    }
+
+    stop = true;
+    for(auto& t : readerThreads) t.join();
+    std::sort(latenciesUs.begin(), latenciesUs.end());
+    std::cout << "   full scans completed: " << scans << std::endl;
+    return latenciesUs;
+}
+
+TEST_F(BenchmarkTest, WriteLatencyDuringFullScans) {
+    const int contacts = 20000;
+    const int writes = 500;
+    const int readers = 4;
+
+    auto report = [](const char* name, const std::vector<double>& latenciesUs) {
+        auto percentile = [&latenciesUs](double p) { return latenciesUs[(size_t)(p * (latenciesUs.size() - 1))]; };
+        std::cout << " " << std::left << std::setw(22) << name << std::fixed << std::setprecision(1)
+                  << " p50: " << percentile(0.5) << " us"
+                  << "  p99: " << percentile(0.99) << " us"
+                  << "  max: " << latenciesUs.back() << " us" << std::endl;
+    };
+
+    std::cout << "\n================ [ WRITES DURING SCANS ] ==================" << std::endl;
+    std::cout << " " << contacts << " contacts, " << readers << " threads running get_all(), "
+              << writes << " writes" << std::endl;
+    auto locking = measureWritesDuringScans<PhonebookRepository>(contacts, writes, readers);
+    report("PhonebookRepository", locking);
+    auto snapshot = measureWritesDuringScans<SnapshotPhonebookRepository>(contacts, writes, readers);
+    report("SnapshotRepository", snapshot);
+    std::cout << "===========================================================\n" << std::endl;
+
+    ASSERT_EQ(locking.size(), writes);
+    ASSERT_EQ(snapshot.size(), writes);
+}
+
 int main(int argc, char **argv) {
     oatpp::base::Environment::init();
     ::testing::InitGoogleTest(&argc, argv);
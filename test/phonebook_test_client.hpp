@@ -3,16 +3,23 @@
 #include "oatpp/web/client/ApiClient.hpp"
 #include "oatpp/core/macro/codegen.hpp"
 #include "dto/phonebook_dto.hpp"
+#include "dto/debug_dto.hpp"
 
 #include OATPP_CODEGEN_BEGIN(ApiClient)
 
 class PhonebookTestClient : public oatpp::web::client::ApiClient {
   API_CLIENT_INIT(PhonebookTestClient)
   API_CALL("GET", "/contacts", get_all_contacts)
+  API_CALL("GET", "/contacts", get_sorted_contacts, QUERY(String, sort), QUERY(String, order), QUERY(String, offset), QUERY(String, limit))
+  API_CALL("GET", "/contacts", get_contacts_after, QUERY(String, sort), QUERY(String, order), QUERY(String, after), QUERY(String, limit))
   API_CALL("POST", "/contacts", create_contact, BODY_DTO(Object<ContactPayloadDto>, payload))
+  API_CALL("POST", "/contacts", create_contact_with_key, HEADER(String, api_key, "X-API-Key"), BODY_DTO(Object<ContactPayloadDto>, payload))
+  API_CALL("POST", "/contacts", create_contact_with_query, QUERY(String, source), BODY_DTO(Object<ContactPayloadDto>, payload))
   API_CALL("PUT", "/contacts/{contact_id}", update_contact, PATH(Int64, contact_id), BODY_DTO(Object<ContactPayloadDto>, payload))
   API_CALL("DELETE", "/contacts/{contact_id}", delete_contact, PATH(Int64, contact_id))
   API_CALL("GET", "/contacts/{contact_id}", get_contact_by_id, PATH(Int64, contact_id))
+  API_CALL("GET", "/contacts/by-phone/{phone}", get_contact_by_phone, PATH(String, phone))
+  API_CALL("GET", "/debug/slow-requests", get_slow_requests)
 
 };
 